@@ -0,0 +1,433 @@
+// Batch simulator: runs thousands of seeded sessions of the game logic with bot input
+// on all cores and reports pool occupancy, collision pairs per frame and the projected
+// frame cost on the 68000. Every session runs on a fresh thread, so it starts from the
+// initial game state (GAME_TLS), workers only bound the number of live sessions.
+//
+// The frame cost is projected from the work done in the frame with a linear cost model.
+// The default coefficients are estimates, --cost replaces one with a figure measured
+// by microbench or the soak harness.
+//
+// Usage: batchsim [--sessions n] [--threads n] [--frames n] [--seed n] [--players 1|2]
+//                 [--skill percent] [--pal] [--cost name=cycles] [--out file]
+//
+// Object limits are compile time, build with BATCHSIM_DEFINES to try others.
+//
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <genesis.h>
+#include "host_stub.h"
+#include "game.h"
+#include "globals.h"
+#include "particles.h"
+#include "loader.h"
+
+#define DEFAULT_SESSIONS        1000
+#define DEFAULT_FRAMES          3600
+
+#define COST_BUCKETS            40      // Frame cost histogram, 5% of the frame budget each
+#define COST_BUCKET_PERCENT     5
+#define PAIR_BUCKETS            64      // Collision pairs histogram, 8 pairs each
+#define PAIR_BUCKET_SIZE        8
+
+// Occupancy tracked per pool
+typedef enum
+{
+    SIM_ENEMIES,
+    SIM_PROJECTILES,
+    SIM_EXPLOSIONS,
+    SIM_PARTICLES,
+    SIM_POOL_COUNT
+} SimPool;
+
+// Work counted per frame, weighted by the cost model
+typedef enum
+{
+    COST_BASE,
+    COST_ENEMY,
+    COST_PROJECTILE,
+    COST_EXPLOSION,
+    COST_PARTICLE,
+    COST_PAIR,
+    COST_FRAME_CHANGE,
+    COST_COUNT
+} SimCost;
+
+typedef struct
+{
+    u32 sessions;
+    u16 threads;
+    u32 frames;
+    u32 seed;
+    u16 players;
+    u16 skill;              // Percent of frames the bot plays to its plan
+    const char *outPath;
+} SimConfig;
+
+typedef struct
+{
+    u32 seed;
+    u16 peak[SIM_POOL_COUNT];
+    u32 framesFull[SIM_POOL_COUNT];     // Frames with the pool at capacity
+    u32 poolFailures;
+    u32 pairsMax;
+    u32 costMax;
+    u32 overBudget;                     // Frames projected above the frame budget
+    u16 deaths;
+    u32 pairHistogram[PAIR_BUCKETS];
+    u32 costHistogram[COST_BUCKETS];
+} SimSession;
+
+static const char *const poolNames[SIM_POOL_COUNT] = {"enemies", "projectiles", "explosions", "particles"};
+static const u16 poolCapacity[SIM_POOL_COUNT] = {MAX_ENEMIES, MAX_BULLETS, MAX_EXPLOSION, MAX_PARTICLES};
+
+static const char *const costNames[COST_COUNT] = {
+    "base", "enemy", "projectile", "explosion", "particle", "pair", "frame_change"
+};
+
+// 68000 cycles, estimates until replaced with measured ones
+static u32 costCycles[COST_COUNT] = {
+    [COST_BASE] = 9000,
+    [COST_ENEMY] = 1100,
+    [COST_PROJECTILE] = 600,
+    [COST_EXPLOSION] = 700,
+    [COST_PARTICLE] = 260,
+    [COST_PAIR] = 90,
+    [COST_FRAME_CHANGE] = 350,
+};
+
+static SimConfig config = {DEFAULT_SESSIONS, 0, DEFAULT_FRAMES, 1, 2, 90, NULL};
+static SimSession *sessions;
+static atomic_uint nextSession;
+static u32 frameBudget;
+
+
+// Session random numbers, apart from the SGDK generator the game uses
+static u32 Sim_Random(u32 *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Bot: joins, fires all the time, lines up with the closest enemy ahead and dodges
+// enemies about to hit, plays randomly for the rest of the frames
+static u16 Sim_Bot(Player *player, u32 frame, u32 *random)
+{
+    u16 buttons = BUTTON_A;
+
+    if (player->state == PL_STATE_SUSPENDED)
+        return (frame % 30 == player->index * 15) ? BUTTON_START : 0;
+
+    if (Sim_Random(random) % 100 >= config.skill)
+        return buttons | (Sim_Random(random) & (BUTTON_UP | BUTTON_DOWN | BUTTON_LEFT | BUTTON_RIGHT));
+
+    Enemy *target = NULL;
+    FOREACH_ALLOCATED_IN_POOL(Enemy, enemy, game.enemyPool)
+    {
+        fix16 dx = enemy->x - player->x;
+
+        // Too close to shoot down in time, get out of its line
+        if (dx > 0 && dx < FIX16(48) && abs(enemy->y - player->y) < FIX16(ENEMY_HEIGHT))
+            return buttons | (enemy->y > player->y ? BUTTON_UP : BUTTON_DOWN);
+
+        if (dx > 0 && (!target || enemy->x < target->x))
+            target = enemy;
+    }
+
+    fix16 targetY = target ? target->y : FIX16(SCREEN_HEIGHT / 2);
+    if (player->y < targetY - FIX16(4))
+        buttons |= BUTTON_DOWN;
+    else if (player->y > targetY + FIX16(4))
+        buttons |= BUTTON_UP;
+
+    if (player->x < FIX16(32))
+        buttons |= BUTTON_RIGHT;
+    else if (player->x > FIX16(64))
+        buttons |= BUTTON_LEFT;
+
+    return buttons;
+}
+
+// One session from power on, runs on its own thread
+static void *Sim_RunSession(void *arg)
+{
+    SimSession *session = arg;
+    u32 random = session->seed * 2654435761u | 1;
+    PlayerState lastState[2] = {PL_STATE_SUSPENDED, PL_STATE_SUSPENDED};
+
+    HostStub_SetRandomSeed(session->seed);
+    Game_Init();
+    while (Loader_IsLoading())
+    {
+        HostStub_VBlank();
+        Game_Frame();
+    }
+    memset(&hostCounters, 0, sizeof(hostCounters));
+
+    for (u32 frame = 0; frame < config.frames; frame++)
+    {
+        HostCounters before = hostCounters;
+
+        FOREACH_PLAYER(player)
+        {
+            bool playing = player->index < config.players;
+            HostStub_SetJoypad(player->index, playing ? Sim_Bot(player, frame, &random) : 0);
+
+            if (player->state == PL_STATE_DIED && lastState[player->index] != PL_STATE_DIED)
+                session->deaths++;
+            lastState[player->index] = player->state;
+        }
+
+        HostStub_VBlank();
+        Game_Frame();
+
+        u16 used[SIM_POOL_COUNT] = {
+            POOL_getNumAllocated(game.enemyPool),
+            POOL_getNumAllocated(game.projectilePool),
+            POOL_getNumAllocated(game.explosionPool),
+            Particles_GetCount(),
+        };
+        for (u16 i = 0; i < SIM_POOL_COUNT; i++)
+        {
+            session->peak[i] = max(session->peak[i], used[i]);
+            if (used[i] == poolCapacity[i])
+                session->framesFull[i]++;
+        }
+
+        u32 pairs = hostCounters.collisionTests - before.collisionTests;
+        u32 cost = costCycles[COST_BASE] + used[SIM_ENEMIES] * costCycles[COST_ENEMY] +
+                   used[SIM_PROJECTILES] * costCycles[COST_PROJECTILE] +
+                   used[SIM_EXPLOSIONS] * costCycles[COST_EXPLOSION] +
+                   used[SIM_PARTICLES] * costCycles[COST_PARTICLE] + pairs * costCycles[COST_PAIR] +
+                   (hostCounters.frameChanges - before.frameChanges) * costCycles[COST_FRAME_CHANGE];
+
+        session->pairsMax = max(session->pairsMax, pairs);
+        session->pairHistogram[min(pairs / PAIR_BUCKET_SIZE, PAIR_BUCKETS - 1)]++;
+        session->costMax = max(session->costMax, cost);
+        session->costHistogram[min(cost * 100 / frameBudget / COST_BUCKET_PERCENT, COST_BUCKETS - 1)]++;
+        if (cost > frameBudget)
+            session->overBudget++;
+    }
+
+    session->poolFailures = hostCounters.poolFailures;
+    HostStub_FreeAll();
+    return NULL;
+}
+
+// Worker: takes the next session and runs it on a fresh thread for a clean game state
+static void *Sim_Worker(void *arg)
+{
+    u32 index;
+
+    while ((index = atomic_fetch_add(&nextSession, 1)) < config.sessions)
+    {
+        pthread_t thread;
+        pthread_create(&thread, NULL, Sim_RunSession, &sessions[index]);
+        pthread_join(thread, NULL);
+    }
+
+    return NULL;
+}
+
+// Value below which a share of the histogram lies, in units of the bucket width
+static u32 Sim_Percentile(const u32 *histogram, u16 buckets, unsigned long long total, u16 percent)
+{
+    unsigned long long seen = 0;
+
+    for (u16 i = 0; i < buckets; i++)
+    {
+        seen += histogram[i];
+        if (seen * 100 >= total * percent)
+            return i + 1;
+    }
+
+    return buckets;
+}
+
+static void Sim_Report()
+{
+    u32 pairHistogram[PAIR_BUCKETS] = {0};
+    u32 costHistogram[COST_BUCKETS] = {0};
+    unsigned long long frames = (unsigned long long) config.sessions * config.frames;
+    unsigned long long overBudget = 0;
+    unsigned long long failures = 0;
+    u32 pairsMax = 0;
+    u32 costMax = 0;
+    u32 sessionsOver = 0;
+
+    for (u32 s = 0; s < config.sessions; s++)
+    {
+        for (u16 i = 0; i < PAIR_BUCKETS; i++)
+            pairHistogram[i] += sessions[s].pairHistogram[i];
+        for (u16 i = 0; i < COST_BUCKETS; i++)
+            costHistogram[i] += sessions[s].costHistogram[i];
+
+        overBudget += sessions[s].overBudget;
+        failures += sessions[s].poolFailures;
+        pairsMax = max(pairsMax, sessions[s].pairsMax);
+        costMax = max(costMax, sessions[s].costMax);
+        if (sessions[s].overBudget)
+            sessionsOver++;
+    }
+
+    printf("%u sessions of %u frames, %u player(s), bot skill %u%%, %s\n\n", config.sessions, config.frames,
+           config.players, config.skill, hostPalSystem ? "PAL" : "NTSC");
+
+    printf("%-12s %8s %8s %10s %12s\n", "pool", "capacity", "peak", "mean peak", "frames full");
+    for (u16 i = 0; i < SIM_POOL_COUNT; i++)
+    {
+        u16 peak = 0;
+        unsigned long long peakSum = 0;
+        unsigned long long full = 0;
+
+        for (u32 s = 0; s < config.sessions; s++)
+        {
+            peak = max(peak, sessions[s].peak[i]);
+            peakSum += sessions[s].peak[i];
+            full += sessions[s].framesFull[i];
+        }
+        printf("%-12s %8u %8u %10.1f %11.2f%%\n", poolNames[i], poolCapacity[i], peak,
+               (double) peakSum / config.sessions, 100.0 * full / frames);
+    }
+    printf("pool allocations failed: %llu\n\n", failures);
+
+    printf("collision pairs per frame: p50 <%u, p90 <%u, p99 <%u, max %u\n",
+           Sim_Percentile(pairHistogram, PAIR_BUCKETS, frames, 50) * PAIR_BUCKET_SIZE,
+           Sim_Percentile(pairHistogram, PAIR_BUCKETS, frames, 90) * PAIR_BUCKET_SIZE,
+           Sim_Percentile(pairHistogram, PAIR_BUCKETS, frames, 99) * PAIR_BUCKET_SIZE, pairsMax);
+
+    printf("projected frame cost (budget %u cycles): p50 <%u%%, p90 <%u%%, p99 <%u%%, max %u%%\n", frameBudget,
+           Sim_Percentile(costHistogram, COST_BUCKETS, frames, 50) * COST_BUCKET_PERCENT,
+           Sim_Percentile(costHistogram, COST_BUCKETS, frames, 90) * COST_BUCKET_PERCENT,
+           Sim_Percentile(costHistogram, COST_BUCKETS, frames, 99) * COST_BUCKET_PERCENT,
+           (u32) ((unsigned long long) costMax * 100 / frameBudget));
+    printf("frames over budget: %llu (%.3f%%) in %u sessions\n\n", overBudget, 100.0 * overBudget / frames,
+           sessionsOver);
+
+    for (u16 i = 0; i < COST_BUCKETS; i++)
+    {
+        if (costHistogram[i])
+            printf("  %3u-%3u%% %10u %7.3f%%%s\n", i * COST_BUCKET_PERCENT, (i + 1) * COST_BUCKET_PERCENT - 1,
+                   costHistogram[i], 100.0 * costHistogram[i] / frames,
+                   i == COST_BUCKETS - 1 ? " and above" : "");
+    }
+}
+
+// One row per session, tab separated
+static void Sim_WriteSessions(const char *path)
+{
+    FILE *file = fopen(path, "w");
+
+    if (!file)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+        exit(1);
+    }
+
+    fprintf(file, "seed");
+    for (u16 i = 0; i < SIM_POOL_COUNT; i++)
+        fprintf(file, "\tpeak_%s\tfull_%s", poolNames[i], poolNames[i]);
+    fprintf(file, "\tpool_failures\tpairs_max\tcost_max\tover_budget\tdeaths\n");
+
+    for (u32 s = 0; s < config.sessions; s++)
+    {
+        const SimSession *session = &sessions[s];
+
+        fprintf(file, "%u", session->seed);
+        for (u16 i = 0; i < SIM_POOL_COUNT; i++)
+            fprintf(file, "\t%u\t%u", session->peak[i], session->framesFull[i]);
+        fprintf(file, "\t%u\t%u\t%u\t%u\t%u\n", session->poolFailures, session->pairsMax, session->costMax,
+                session->overBudget, session->deaths);
+    }
+
+    fclose(file);
+}
+
+// Replace a cost model coefficient, given as name=cycles
+static bool Sim_SetCost(const char *arg)
+{
+    for (u16 i = 0; i < COST_COUNT; i++)
+    {
+        size_t length = strlen(costNames[i]);
+        if (!strncmp(arg, costNames[i], length) && arg[length] == '=')
+        {
+            costCycles[i] = atoi(arg + length + 1);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static void Sim_ParseArgs(int argc, char **argv)
+{
+    bool usage = FALSE;
+
+    for (int i = 1; i < argc && !usage; i++)
+    {
+        if (!strcmp(argv[i], "--sessions") && i + 1 < argc)
+            config.sessions = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            config.threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            config.frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            config.seed = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--players") && i + 1 < argc)
+            config.players = atoi(argv[++i]) == 1 ? 1 : 2;
+        else if (!strcmp(argv[i], "--skill") && i + 1 < argc)
+            config.skill = min(atoi(argv[++i]), 100);
+        else if (!strcmp(argv[i], "--pal"))
+            hostPalSystem = TRUE;
+        else if (!strcmp(argv[i], "--cost") && i + 1 < argc)
+            usage = !Sim_SetCost(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            config.outPath = argv[++i];
+        else
+            usage = TRUE;
+    }
+
+    if (usage || !config.sessions || !config.frames)
+    {
+        fprintf(stderr, "usage: %s [--sessions n] [--threads n] [--frames n] [--seed n] [--players 1|2] "
+                        "[--skill percent] [--pal] [--cost name=cycles] [--out file]\n", argv[0]);
+        fprintf(stderr, "cost names:");
+        for (u16 i = 0; i < COST_COUNT; i++)
+            fprintf(stderr, " %s", costNames[i]);
+        fprintf(stderr, "\n");
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Sim_ParseArgs(argc, argv);
+
+    if (!config.threads)
+        config.threads = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+
+    // 3420 master clocks per line, the 68000 runs at a seventh of the master clock
+    frameBudget = (hostPalSystem ? 313 : 262) * 3420 / 7;
+
+    sessions = calloc(config.sessions, sizeof(SimSession));
+    for (u32 s = 0; s < config.sessions; s++)
+        sessions[s].seed = config.seed + s;
+
+    pthread_t *workers = calloc(config.threads, sizeof(pthread_t));
+    for (u16 i = 0; i < config.threads; i++)
+        pthread_create(&workers[i], NULL, Sim_Worker, NULL);
+    for (u16 i = 0; i < config.threads; i++)
+        pthread_join(workers[i], NULL);
+    free(workers);
+
+    Sim_Report();
+    if (config.outPath)
+        Sim_WriteSessions(config.outPath);
+
+    return 0;
+}
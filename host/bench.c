@@ -0,0 +1,236 @@
+// Headless benchmark of the game logic. Runs the real frame loop against the stubbed
+// SGDK for a number of frames with scripted joypad input and reports the time of
+// every profiler stage and the work done through the SGDK API.
+//
+// Usage: bench [frames] [--players 1|2] [--pal] [--load percent] [--verbose]
+//              [--record file] [--replay file]
+//
+// --record saves the joypad stream with the state hash of every step, --replay runs
+// a saved stream instead of the script and reports the first step that differs.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <genesis.h>
+#include "host_stub.h"
+#include "game.h"
+#include "globals.h"
+#include "profiler.h"
+#include "input.h"
+#include "loader.h"
+#include "dma_budget.h"
+#include "sfx.h"
+#include "music.h"
+#include "arena.h"
+
+#define DEFAULT_FRAMES      3600
+
+typedef struct
+{
+    u32 frames;
+    u16 players;
+    const char *recordPath;
+    const char *replayPath;
+} BenchConfig;
+
+typedef struct
+{
+    unsigned long long total;
+    u32 max;
+} BenchTime;
+
+
+// Nanoseconds of a monotonic clock
+static unsigned long long Bench_Now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// Scripted joypad: fire held, vertical sweep, START pulses to join and rejoin
+static u16 Bench_Input(u32 frame, u16 player)
+{
+    u32 phase = (frame + player * 45) % 180;
+    u16 buttons = BUTTON_A;
+
+    buttons |= (phase < 90) ? BUTTON_UP : BUTTON_DOWN;
+    if ((frame / 120) % 4 == 1)
+        buttons |= BUTTON_RIGHT;
+    else if ((frame / 120) % 4 == 3)
+        buttons |= BUTTON_LEFT;
+
+    if (frame % 300 == 60)
+        buttons |= BUTTON_START;
+
+    return buttons;
+}
+
+// Add a sample to a time accumulator
+static void Bench_AddTime(BenchTime *time, u32 ns)
+{
+    time->total += ns;
+    if (ns > time->max)
+        time->max = ns;
+}
+
+static void Bench_ParseArgs(int argc, char **argv, BenchConfig *config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--players") && i + 1 < argc)
+            config->players = atoi(argv[++i]) == 2 ? 2 : 1;
+        else if (!strcmp(argv[i], "--pal"))
+            hostPalSystem = TRUE;
+        else if (!strcmp(argv[i], "--load") && i + 1 < argc)
+            HostStub_SetCPULoad(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--record") && i + 1 < argc)
+            config->recordPath = argv[++i];
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+            config->replayPath = argv[++i];
+        else if (!strcmp(argv[i], "--verbose"))
+            HostStub_SetVerbose(TRUE);
+        else if (atoi(argv[i]) > 0)
+            config->frames = atoi(argv[i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [frames] [--players 1|2] [--pal] [--load percent] [--verbose] "
+                            "[--record file] [--replay file]\n", argv[0]);
+            exit(1);
+        }
+    }
+}
+
+// Load or save the input recording as a raw image of the recording buffer
+static void Bench_TransferRecording(const char *path, bool save)
+{
+    FILE *file = fopen(path, save ? "wb" : "rb");
+    size_t done = 0;
+
+    if (file)
+    {
+        done = save ? fwrite(Input_GetRecording(), sizeof(InputRecording), 1, file)
+                    : fread(Input_GetRecording(), sizeof(InputRecording), 1, file);
+        fclose(file);
+    }
+
+    if (done != 1)
+    {
+        fprintf(stderr, "cannot %s %s\n", save ? "write" : "read", path);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig config = {DEFAULT_FRAMES, 1, NULL, NULL};
+    BenchTime stages[PROF_STAGE_COUNT] = {0};
+    BenchTime frameTime = {0};
+    u16 peakEnemies = 0;
+    u16 peakProjectiles = 0;
+    u16 peakExplosions = 0;
+    const InputLatency *latency;
+
+    Bench_ParseArgs(argc, argv, &config);
+
+    Game_Init();
+    // Startup frames stream the backgrounds and finish the setup, they are not measured
+    while (Loader_IsLoading())
+    {
+        HostStub_VBlank();
+        Game_Frame();
+    }
+    HostCounters init = hostCounters;
+
+    if (config.replayPath)
+    {
+        Bench_TransferRecording(config.replayPath, FALSE);
+        Input_StartReplay();
+        config.frames = min(config.frames, Input_GetRecording()->numSteps);
+    }
+    else if (config.recordPath)
+        Input_StartRecording();
+
+    memset(&hostCounters, 0, sizeof(hostCounters));
+
+    for (u32 frame = 0; frame < config.frames; frame++)
+    {
+        HostStub_SetJoypad(JOY_1, Bench_Input(frame, 0));
+        HostStub_SetJoypad(JOY_2, config.players == 2 ? Bench_Input(frame, 1) : 0);
+
+        // The previous frame is uploaded and the next one may start
+        HostStub_VBlank();
+
+        unsigned long long start = Bench_Now();
+        Game_Frame();
+        Bench_AddTime(&frameTime, Bench_Now() - start);
+
+        for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+            Bench_AddTime(&stages[i], Profiler_GetStats(i)->last);
+
+        peakEnemies = max(peakEnemies, POOL_getNumAllocated(game.enemyPool));
+        peakProjectiles = max(peakProjectiles, POOL_getNumAllocated(game.projectilePool));
+        peakExplosions = max(peakExplosions, POOL_getNumAllocated(game.explosionPool));
+    }
+
+    if (config.recordPath)
+    {
+        Input_Stop();
+        Bench_TransferRecording(config.recordPath, TRUE);
+    }
+
+    printf("%u frames, %u player(s), %s, state hash %08x\n", config.frames, config.players,
+           hostPalSystem ? "PAL" : "NTSC", Input_GetHash());
+    printf("boot to first interactive frame: %u frames\n", Loader_GetBootFrames());
+    if (config.recordPath)
+        printf("recorded %u steps to %s\n", Input_GetRecording()->numSteps, config.recordPath);
+    if (config.replayPath)
+    {
+        if (Input_GetDivergedStep() < 0)
+            printf("replay of %s matched\n", config.replayPath);
+        else
+            printf("replay of %s diverged at step %d\n", config.replayPath, Input_GetDivergedStep());
+    }
+    printf("\n");
+
+    printf("%-12s %12s %12s %12s\n", "stage", "total ms", "avg ns", "max ns");
+    for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+        printf("%-12s %12.3f %12llu %12u\n", Profiler_GetStageName(i), stages[i].total / 1e6,
+               stages[i].total / config.frames, stages[i].max);
+    printf("%-12s %12.3f %12llu %12u\n\n", "frame", frameTime.total / 1e6, frameTime.total / config.frames,
+           frameTime.max);
+
+    printf("allocations   init    run\n");
+    printf("  pool        %4u %6u (%u released, %u failed)\n", init.poolAllocs, hostCounters.poolAllocs,
+           hostCounters.poolReleases, hostCounters.poolFailures);
+    printf("  MEM_alloc   %4u %6u\n", init.memAllocs, hostCounters.memAllocs);
+    printf("  sprites     %4u %6u\n", init.spritesAdded, hostCounters.spritesAdded);
+    printf("arena         %u of %u bytes, peak %u:", Arena_GetUsed(), ARENA_SIZE, Arena_GetPeak());
+    for (u16 i = 0; i < ARENA_TAG_COUNT; i++)
+        printf(" %s %u", Arena_GetTagName(i), Arena_GetTagBytes(i));
+    printf("\n");
+    printf("peak objects  enemies %u, projectiles %u, explosions %u\n", peakEnemies, peakProjectiles, peakExplosions);
+    printf("sprite frames %u changes, %u tiles uploaded\n", hostCounters.frameChanges, hostCounters.tileUploads);
+    printf("dma queue     %u transfers, %u bytes (%u per frame)\n", hostCounters.dmaTransfers, hostCounters.dmaBytes,
+           hostCounters.dmaBytes / config.frames);
+    printf("dma budget    %u bytes per vblank, %u overruns\n", DmaBudget_GetCapacity(), DmaBudget_GetOverruns());
+    for (u16 i = 0; i < DMA_CLASS_COUNT; i++)
+    {
+        const DmaClassStats *dma = DmaBudget_GetStats(i);
+        printf("  %-10s  %u bytes (%u per frame, %u peak), %u deferred\n", DmaBudget_GetClassName(i), dma->totalBytes,
+               dma->totalBytes / config.frames, dma->peakBytes, dma->deferredBytes);
+    }
+    printf("pcm triggers  %u of %u requests, %u dropped\n", hostCounters.pcmTriggers, Sfx_GetStats()->requests,
+           Sfx_GetStats()->dropped);
+    printf("music         track %d, %u driver commands\n", Music_GetTrack(), Music_GetCommands());
+
+    latency = Input_GetLatency();
+    if (latency->count)
+        printf("input latency %u probes, last %u, min %u, max %u, avg %.2f frames, %u dropped\n", latency->count,
+               latency->last, latency->min, latency->max, (double) latency->sum / latency->count, latency->dropped);
+    else
+        printf("input latency no probes, %u dropped\n", latency->dropped);
+
+    return 0;
+}
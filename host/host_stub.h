@@ -0,0 +1,45 @@
+#ifndef HEADER_HOST_STUB
+#define HEADER_HOST_STUB
+
+#include <genesis.h>
+
+// Stub state is per thread in threaded builds, like the game state (GAME_TLS)
+#if HOST_THREADS
+#define HOST_TLS            _Thread_local
+#else
+#define HOST_TLS
+#endif
+
+// Work the game asked from the stubbed SGDK, reset by the caller
+typedef struct
+{
+    u32 poolAllocs;             // Successful POOL_allocate calls
+    u32 poolFailures;           // POOL_allocate calls on an empty pool
+    u32 poolReleases;
+    u32 memAllocs;              // MEM_alloc calls
+    u32 spritesAdded;           // SPR_addSprite(Ex) calls
+    u32 spriteUpdates;          // SPR_update calls
+    u32 frameChanges;           // Animation frame changes done by SPR_update
+    u32 tileUploads;            // Tiles sent with VDP_loadTileSet
+    u32 dmaTransfers;           // Transfers queued
+    u32 dmaBytes;               // Bytes queued
+    u32 pcmTriggers;
+    u32 collisionTests;         // Object pairs tested by GameObject_IsCollided
+} HostCounters;
+
+
+extern HOST_TLS HostCounters hostCounters;
+
+void HostStub_SetJoypad(u16 joy, u16 buttons);
+
+void HostStub_SetVerbose(bool verbose);
+
+void HostStub_SetCPULoad(u16 load);
+
+void HostStub_VBlank();
+
+void HostStub_SetRandomSeed(u16 seed);
+
+void HostStub_FreeAll();
+
+#endif //HEADER_HOST_STUB
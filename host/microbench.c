@@ -0,0 +1,24 @@
+// Host run of the kernel microbenchmarks (src/microbench.c). Nanoseconds of the host
+// CPU only rank the kernels, cycles on the 68000 come from a ROM built with MICROBENCH.
+//
+// Usage: microbench
+//
+
+#include <stdio.h>
+#include <genesis.h>
+#include "microbench.h"
+
+#define MAX_RESULTS     64
+
+int main()
+{
+    static MicrobenchResult results[MAX_RESULTS];
+    u16 count = Microbench_Run(results, MAX_RESULTS);
+
+    printf("kernel\tsize\truns\t" MICROBENCH_UNIT "_per_call\n");
+    for (u16 i = 0; i < count; i++)
+        printf("%s\t%u\t%u\t%u.%u\n", results[i].kernel, results[i].size, results[i].runs, results[i].perCall / 10,
+               results[i].perCall % 10);
+
+    return 0;
+}
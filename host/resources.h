@@ -0,0 +1,25 @@
+// Host declarations of the rescomp resources, sized like the stand-ins in
+// resources_stub.c. The ROM build includes res/resources.h instead, which rescomp
+// generates from res/resources.res on every build.
+//
+
+#ifndef _RES_RESOURCES_H_
+#define _RES_RESOURCES_H_
+
+#include <genesis.h>
+
+extern const u8 xpcm_shoot[2560];
+extern const u8 xpcm_explosion[8960];
+extern const u8 xgm2_music[11264];
+extern const TileSet bgTileset;
+extern const Palette bgPalette;
+extern const u8 mapTilemapData[3584];
+extern const u8 backTilemapData[2560];
+extern const TileSet anim_star;
+extern const SpriteDefinition player_sprite;
+extern const SpriteDefinition enemy_sprite;
+extern const SpriteDefinition bullet_sprite;
+extern const SpriteDefinition explosion_sprite;
+extern const SpriteDefinition particle_sprite;
+
+#endif // _RES_RESOURCES_H_
@@ -0,0 +1,79 @@
+// Host stand-ins for the rescomp resources. No pixels, only the layout the game
+// logic reads: animation and frame counts, frame timers, tile counts and codecs,
+// sized after the sheets in res/.
+//
+
+#include <genesis.h>
+#include "resources.h"
+
+// Tile set without data, compression as in resources.res
+#define TILESET(name, compression, tiles) \
+    static TileSet name = {compression, tiles, NULL}
+
+// Animation frame with its tile set and timer
+#define FRAME(name, tileset, frameTimer) \
+    static AnimationFrame name = {1, frameTimer, &tileset}
+
+// Palette of black colors, each sheet has its own so palette lines get shared like on the console
+#define PALETTE(name) \
+    static u16 name##Data[16]; \
+    static Palette name = {16, name##Data}
+
+// Blank data, sized by the declarations in resources.h
+const u8 xpcm_shoot[];
+const u8 xpcm_explosion[];
+const u8 xgm2_music[];
+
+// Backgrounds: shared tile set of both planes, tilemaps of blank entries
+const TileSet bgTileset = {COMPRESSION_APLIB, 709, NULL};
+static u16 bgPaletteData[16];
+const Palette bgPalette = {16, bgPaletteData};
+const u8 mapTilemapData[];
+const u8 backTilemapData[];
+const TileSet anim_star = {COMPRESSION_NONE, 64, NULL};
+
+// Player: 4x4 tiles, neutral, up and down animations of 2 frames
+PALETTE(playerPalette);
+TILESET(playerTiles, COMPRESSION_APLIB, 16);
+FRAME(playerFrame, playerTiles, 5);
+static AnimationFrame *playerFrames[] = {&playerFrame, &playerFrame};
+static Animation playerAnimation = {2, 0, playerFrames};
+static Animation *playerAnimations[] = {&playerAnimation, &playerAnimation, &playerAnimation};
+const SpriteDefinition player_sprite = {32, 32, &playerPalette, 3, playerAnimations, 16, 1};
+
+// Enemy: 4x4 tiles, 2 still frames
+PALETTE(enemyPalette);
+TILESET(enemyTiles, COMPRESSION_APLIB, 16);
+FRAME(enemyFrame, enemyTiles, 0);
+static AnimationFrame *enemyFrames[] = {&enemyFrame, &enemyFrame};
+static Animation enemyAnimation = {2, 0, enemyFrames};
+static Animation *enemyAnimations[] = {&enemyAnimation};
+const SpriteDefinition enemy_sprite = {32, 32, &enemyPalette, 1, enemyAnimations, 16, 1};
+
+// Bullet: 4x2 tiles, 5 frames
+PALETTE(bulletPalette);
+TILESET(bulletTiles, COMPRESSION_APLIB, 8);
+FRAME(bulletFrame, bulletTiles, 2);
+static AnimationFrame *bulletFrames[] = {&bulletFrame, &bulletFrame, &bulletFrame, &bulletFrame, &bulletFrame};
+static Animation bulletAnimation = {5, 0, bulletFrames};
+static Animation *bulletAnimations[] = {&bulletAnimation};
+const SpriteDefinition bullet_sprite = {32, 16, &bulletPalette, 1, bulletAnimations, 8, 1};
+
+// Explosion: 4x4 tiles, 8 frames
+PALETTE(explosionPalette);
+TILESET(explosionTiles, COMPRESSION_NONE, 16);
+FRAME(explosionFrame, explosionTiles, 3);
+static AnimationFrame *explosionFrames[] = {&explosionFrame, &explosionFrame, &explosionFrame, &explosionFrame,
+                                            &explosionFrame, &explosionFrame, &explosionFrame, &explosionFrame};
+static Animation explosionAnimation = {8, 0, explosionFrames};
+static Animation *explosionAnimations[] = {&explosionAnimation};
+const SpriteDefinition explosion_sprite = {32, 32, &explosionPalette, 1, explosionAnimations, 16, 1};
+
+// Particle: 1 tile, one still frame per particle type
+PALETTE(particlePalette);
+TILESET(particleTiles, COMPRESSION_APLIB, 1);
+FRAME(particleFrame, particleTiles, 0);
+static AnimationFrame *particleFrames[] = {&particleFrame, &particleFrame, &particleFrame};
+static Animation particleAnimation = {3, 0, particleFrames};
+static Animation *particleAnimations[] = {&particleAnimation};
+const SpriteDefinition particle_sprite = {8, 8, &particlePalette, 1, particleAnimations, 1, 1};
@@ -0,0 +1,365 @@
+// Host stand-in for the part of the SGDK API the game uses. Declarations keep the
+// SGDK signatures, the implementation in sgdk_stub.c only keeps the state the game
+// logic reads back (pools, sprite animation, joypads, SRAM) and counts the rest.
+//
+
+#ifndef HEADER_HOST_GENESIS
+#define HEADER_HOST_GENESIS
+
+#include <string.h>
+#include "types.h"
+#include "maths.h"
+
+// --- Tiles, palettes and images ---
+
+#define PAL0                0
+#define PAL1                1
+#define PAL2                2
+#define PAL3                3
+
+#define TILE_USER_INDEX     16
+#define TILE_FONT_INDEX     1696
+
+#define TILE_ATTR(pal, prio, flipV, flipH) \
+    (((flipH) << 11) | ((flipV) << 12) | ((pal) << 13) | ((prio) << 15))
+#define TILE_ATTR_FULL(pal, prio, flipV, flipH, index) \
+    (TILE_ATTR(pal, prio, flipV, flipH) | (index))
+#define TILE_INDEX_MASK         0x07FF
+
+#define COMPRESSION_NONE        0
+#define COMPRESSION_APLIB       1
+#define COMPRESSION_LZ4W        2
+
+typedef struct
+{
+    u16 compression;
+    u16 numTile;
+    u32 *tiles;
+} TileSet;
+
+typedef struct
+{
+    u16 length;
+    u16 *data;
+} Palette;
+
+typedef struct
+{
+    u16 compression;
+    u16 w;
+    u16 h;
+    u16 *tilemap;
+} TileMap;
+
+typedef struct
+{
+    Palette *palette;
+    TileSet *tileset;
+    TileMap *tilemap;
+} Image;
+
+// --- VDP ---
+
+typedef enum
+{
+    BG_B,
+    BG_A,
+    WINDOW
+} VDPPlane;
+
+typedef enum
+{
+    CPU,
+    DMA,
+    DMA_QUEUE,
+    DMA_QUEUE_COPY
+} TransferMethod;
+
+typedef enum
+{
+    DMA_VRAM,
+    DMA_CRAM,
+    DMA_VSRAM
+} DMAOpType;
+
+#define HSCROLL_PLANE       0
+#define HSCROLL_TILE        2
+#define HSCROLL_LINE        3
+#define VSCROLL_PLANE       0
+#define VSCROLL_COLUMN      1
+
+#define GET_HVCOUNTER       HostStub_GetHVCounter()
+#define GET_VCOUNTER        (GET_HVCOUNTER >> 8)
+
+u16 HostStub_GetHVCounter();
+
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll);
+
+bool VDP_drawImageEx(VDPPlane plane, const Image *image, u16 basetile, u16 x, u16 y, bool loadpal, TransferMethod tm);
+
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16 *values, u16 len, TransferMethod tm);
+
+u16 VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm);
+
+void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm);
+
+bool VDP_setTileMapEx(VDPPlane plane, const TileMap *tilemap, u16 basetile, u16 x, u16 y, u16 xm, u16 ym, u16 wm,
+                      u16 hm, TransferMethod tm);
+
+void VDP_setEnable(bool value);
+
+TileSet *unpackTileSet(const TileSet *src, TileSet *dest);
+
+TileMap *unpackTileMap(const TileMap *src, TileMap *dest);
+
+u16 VDP_getPlaneAddress(VDPPlane plane, u16 x, u16 y);
+
+void VDP_setBackgroundColor(u16 value);
+
+void VDP_setTextPalette(u16 palette);
+
+void VDP_setWindowOnBottom(u16 value);
+
+void VDP_setTextPlane(VDPPlane plane);
+
+// --- DMA ---
+
+bool DMA_queueDma(DMAOpType location, void *from, u16 to, u16 len, u16 step);
+
+void DMA_flushQueue();
+
+u16 DMA_getQueueSize();
+
+u32 DMA_getQueueTransferSize();
+
+// --- Sprite engine ---
+
+typedef struct
+{
+    u8 numSprite;
+    u8 timer;
+    TileSet *tileset;
+} AnimationFrame;
+
+typedef struct
+{
+    u8 numFrame;
+    u8 loop;
+    AnimationFrame **frames;
+} Animation;
+
+typedef struct
+{
+    u16 w;
+    u16 h;
+    Palette *palette;
+    u16 numAnimation;
+    Animation **animations;
+    u16 maxNumTile;
+    u16 maxNumSprite;
+} SpriteDefinition;
+
+typedef struct Sprite
+{
+    u16 status;
+    u16 visibility;
+    const SpriteDefinition *definition;
+    void (*onFrameChange)(struct Sprite *sprite);
+    Animation *animation;
+    AnimationFrame *frame;
+    s16 animInd;
+    s16 frameInd;
+    u16 attribut;
+    s16 x;
+    s16 y;
+    u16 timer;
+    u32 data;
+} Sprite;
+
+typedef enum
+{
+    VISIBLE,
+    HIDDEN,
+    AUTO_FAST,
+    AUTO_SLOW
+} SpriteVisibility;
+
+#define SPR_FLAG_AUTO_VISIBILITY        0x4000
+#define SPR_FLAG_AUTO_SPRITE_ALLOC      0x0800
+#define SPR_FLAG_AUTO_TILE_UPLOAD       0x0400
+
+void SPR_initEx(u16 vramSize);
+
+Sprite *SPR_addSprite(const SpriteDefinition *spriteDef, s16 x, s16 y, u16 attribut);
+
+Sprite *SPR_addSpriteEx(const SpriteDefinition *spriteDef, s16 x, s16 y, u16 attribut, u16 flag);
+
+void SPR_releaseSprite(Sprite *sprite);
+
+void SPR_setPosition(Sprite *sprite, s16 x, s16 y);
+
+void SPR_setVisibility(Sprite *sprite, SpriteVisibility value);
+
+void SPR_setPalette(Sprite *sprite, u16 value);
+
+void SPR_setAlwaysOnTop(Sprite *sprite);
+
+void SPR_setAnim(Sprite *sprite, s16 anim);
+
+void SPR_setFrame(Sprite *sprite, s16 frame);
+
+void SPR_setAnimAndFrame(Sprite *sprite, s16 anim, s16 frame);
+
+void SPR_setAnimationLoop(Sprite *sprite, bool value);
+
+bool SPR_isAnimationDone(Sprite *sprite);
+
+void SPR_setFrameChangeCallback(Sprite *sprite, void (*callback)(Sprite *sprite));
+
+bool SPR_setVRAMTileIndex(Sprite *sprite, s16 value);
+
+u16 **SPR_loadAllFrames(const SpriteDefinition *sprDef, u16 index, u16 *totalNumTile);
+
+void SPR_update();
+
+// --- Object pools ---
+
+typedef struct
+{
+    void *bank;
+    void **allocStack;
+    void **free;
+    u16 size;
+    u16 objectSize;
+} Pool;
+
+Pool *POOL_create(u16 size, u16 objectSize);
+
+void POOL_reset(Pool *pool, bool clear);
+
+void *POOL_allocate(Pool *pool);
+
+void POOL_release(Pool *pool, void *object, bool maintainCoherency);
+
+u16 POOL_getFree(Pool *pool);
+
+u16 POOL_getNumAllocated(Pool *pool);
+
+void **POOL_getFirst(Pool *pool);
+
+// --- Memory ---
+
+void *MEM_alloc(u16 size);
+
+void MEM_free(void *ptr);
+
+void memsetU16(u16 *to, u16 value, u16 len);
+
+void memcpyU16(u16 *to, const u16 *from, u16 len);
+
+// --- Joypad ---
+
+#define JOY_1               0
+#define JOY_2               1
+
+#define BUTTON_UP           0x0001
+#define BUTTON_DOWN         0x0002
+#define BUTTON_LEFT         0x0004
+#define BUTTON_RIGHT        0x0008
+#define BUTTON_A            0x0040
+#define BUTTON_B            0x0010
+#define BUTTON_C            0x0020
+#define BUTTON_START        0x0080
+#define BUTTON_X            0x0400
+#define BUTTON_Y            0x0200
+#define BUTTON_Z            0x0100
+#define BUTTON_MODE         0x0800
+
+void JOY_init();
+
+void JOY_update();
+
+u16 JOY_readJoypad(u16 joy);
+
+// --- Sound ---
+
+#define Z80_DRIVER_XGM2     5
+
+typedef enum
+{
+    SOUND_PCM_CH1,
+    SOUND_PCM_CH2,
+    SOUND_PCM_CH3
+} SoundPCMChannel;
+
+void Z80_loadDriver(u16 driver, bool waitReady);
+
+void XGM2_play(const u8 *song);
+
+void XGM2_load_FAR(const u8 *song, u32 size);
+
+void XGM2_playTrack(u16 track);
+
+void XGM2_fadeOutAndStop(u16 numFrame);
+
+u16 XGM2_getCPULoad(bool mean);
+
+void XGM2_playPCM(const u8 *sample, u32 len, SoundPCMChannel channel);
+
+void XGM2_playPCMEx(const u8 *sample, u32 len, SoundPCMChannel channel, u8 priority, bool halfRate, bool loop);
+
+// --- SRAM ---
+
+void SRAM_enable();
+
+void SRAM_enableRO();
+
+void SRAM_disable();
+
+u8 SRAM_readByte(u32 offset);
+
+u16 SRAM_readWord(u32 offset);
+
+u32 SRAM_readLong(u32 offset);
+
+void SRAM_writeByte(u32 offset, u8 value);
+
+void SRAM_writeWord(u32 offset, u16 value);
+
+void SRAM_writeLong(u32 offset, u32 value);
+
+// --- System ---
+
+#define IS_PAL_SYSTEM       hostPalSystem
+
+extern bool hostPalSystem;
+
+// Vblanks since reset, counted by HostStub_VBlank on the calling thread
+#if HOST_THREADS
+extern _Thread_local vu32 vtimer;
+#else
+extern vu32 vtimer;
+#endif
+
+typedef void VoidCallback();
+
+void SYS_setVIntCallback(VoidCallback *callback);
+
+void SYS_hardReset();
+
+void SYS_disableInts();
+
+void SYS_enableInts();
+
+u32 SYS_getFPS();
+
+u16 SYS_getCPULoad();
+
+// SGDK random() clashes with the C library one
+#define random              SGDK_random
+
+u16 SGDK_random();
+
+void kprintf(const char *fmt, ...);
+
+#endif //HEADER_HOST_GENESIS
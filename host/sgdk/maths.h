@@ -0,0 +1,21 @@
+// Host stand-in for the SGDK fixed point maths (fix16 is 10.6, ff32 is 16.16).
+//
+
+#ifndef HEADER_HOST_MATHS
+#define HEADER_HOST_MATHS
+
+#include "types.h"
+
+#define FIX16_FRAC_BITS     6
+
+#define FIX16(value)        ((fix16) ((value) * (1 << FIX16_FRAC_BITS)))
+#define F16(value)          FIX16(value)
+#define F16_toInt(value)    ((s16) ((value) >> FIX16_FRAC_BITS))
+#define F16_mul(a, b)       ((fix16) (((s32) (a) * (s32) (b)) >> FIX16_FRAC_BITS))
+
+#define FF32(value)         ((ff32) ((value) * 65536))
+#define FF32_toInt(value)   ((s16) ((value) >> 16))
+
+fix16 F16_sin(fix16 angle);
+
+#endif //HEADER_HOST_MATHS
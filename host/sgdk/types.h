@@ -0,0 +1,40 @@
+// Host stand-in for the SGDK types header.
+//
+
+#ifndef HEADER_HOST_TYPES
+#define HEADER_HOST_TYPES
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+typedef volatile int8_t vs8;
+typedef volatile int16_t vs16;
+typedef volatile int32_t vs32;
+typedef volatile uint8_t vu8;
+typedef volatile uint16_t vu16;
+typedef volatile uint32_t vu32;
+
+typedef u16 bool;
+
+typedef s16 fix16;
+typedef s32 fix32;
+typedef s32 ff32;
+
+#define TRUE            1
+#define FALSE           0
+
+#define FORCE_INLINE    inline
+
+#define min(x, y)       (((x) < (y)) ? (x) : (y))
+#define max(x, y)       (((x) > (y)) ? (x) : (y))
+#define abs(x)          (((x) < 0) ? -(x) : (x))
+#define clamp(x, lo, hi) (((x) < (lo)) ? (lo) : (((x) > (hi)) ? (hi) : (x)))
+
+#endif //HEADER_HOST_TYPES
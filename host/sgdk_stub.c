@@ -0,0 +1,698 @@
+// Host implementation of the stubbed SGDK API. Nothing is drawn: VDP and sound calls
+// only count their work, while pools, sprite animation timing, joypads and SRAM
+// behave like on the console because the game logic depends on them.
+//
+
+#include <math.h>
+#include <stdalign.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <genesis.h>
+#include "host_stub.h"
+
+#define MAX_SPRITES         80
+#define SRAM_SIZE           0x10000
+
+// Sprite status bits
+#define SPR_USED            0x0001
+#define SPR_FRAME_CHANGED   0x0002
+#define SPR_ANIM_DONE       0x0004
+#define SPR_NO_LOOP         0x0008
+
+// Header of the blocks handed to the game, freed together by HostStub_FreeAll
+typedef struct HostBlock
+{
+    struct HostBlock *prev;
+    struct HostBlock *next;
+    alignas(max_align_t) u8 data[];
+} HostBlock;
+
+HOST_TLS HostCounters hostCounters;
+bool hostPalSystem = FALSE;
+HOST_TLS vu32 vtimer = 0;
+
+static HOST_TLS Sprite sprites[MAX_SPRITES];
+static HOST_TLS u16 joypads[2];
+static HOST_TLS VoidCallback *vintCallback = NULL;
+static bool verbose = FALSE;
+static u16 cpuLoad = 0;
+static HOST_TLS u16 randomState = 0xD94B;
+
+static HOST_TLS u16 queueSize = 0;
+static HOST_TLS u32 queueBytes = 0;
+
+static HOST_TLS u8 sram[SRAM_SIZE];
+
+static HOST_TLS HostBlock *blocks = NULL;
+
+
+// --- Allocations ---
+
+// Allocate a block owned by the calling thread
+static void *HostStub_Alloc(size_t size, bool clear)
+{
+    HostBlock *block = clear ? calloc(1, sizeof(HostBlock) + size) : malloc(sizeof(HostBlock) + size);
+
+    block->prev = NULL;
+    block->next = blocks;
+    if (blocks)
+        blocks->prev = block;
+    blocks = block;
+
+    return block->data;
+}
+
+static void HostStub_Free(void *ptr)
+{
+    HostBlock *block = (HostBlock *) ((u8 *) ptr - offsetof(HostBlock, data));
+
+    if (block->prev)
+        block->prev->next = block->next;
+    else
+        blocks = block->next;
+    if (block->next)
+        block->next->prev = block->prev;
+
+    free(block);
+}
+
+
+// --- Host controls ---
+
+// Buttons returned by JOY_readJoypad until changed
+void HostStub_SetJoypad(u16 joy, u16 buttons)
+{
+    joypads[joy] = buttons;
+}
+
+// Print kprintf output to stderr
+void HostStub_SetVerbose(bool value)
+{
+    verbose = value;
+}
+
+// Value returned by SYS_getCPULoad
+void HostStub_SetCPULoad(u16 load)
+{
+    cpuLoad = load;
+}
+
+// Seed of the SGDK random generator, zero would stop the xorshift
+void HostStub_SetRandomSeed(u16 seed)
+{
+    randomState = seed ? seed : 0xD94B;
+}
+
+// Free everything the game allocated on this thread, the session cannot go on after it
+void HostStub_FreeAll()
+{
+    while (blocks)
+        HostStub_Free(blocks->data);
+}
+
+// Run the vertical interrupt handler the game installed
+void HostStub_VBlank()
+{
+    vtimer++;
+    if (vintCallback)
+        vintCallback();
+}
+
+// Fixed position at the start of vblank, host timings do not use it
+u16 HostStub_GetHVCounter()
+{
+    return 0xE000;
+}
+
+// --- Maths ---
+
+// Sine of an angle in degrees
+fix16 F16_sin(fix16 angle)
+{
+    return (fix16) lrint(sin(angle / (double) (1 << FIX16_FRAC_BITS) * M_PI / 180.0) * (1 << FIX16_FRAC_BITS));
+}
+
+// Deterministic 16-bit xorshift, the console mixes in the HV counter
+u16 SGDK_random()
+{
+    randomState ^= randomState << 7;
+    randomState ^= randomState >> 9;
+    randomState ^= randomState << 8;
+    return randomState;
+}
+
+// --- VDP and DMA ---
+
+// Count a transfer as queued for the next vblank
+static void HostStub_Queue(u32 bytes)
+{
+    queueSize++;
+    queueBytes += bytes;
+    hostCounters.dmaTransfers++;
+    hostCounters.dmaBytes += bytes;
+}
+
+void VDP_setScrollingMode(u16 hscroll, u16 vscroll)
+{
+}
+
+bool VDP_drawImageEx(VDPPlane plane, const Image *image, u16 basetile, u16 x, u16 y, bool loadpal, TransferMethod tm)
+{
+    hostCounters.tileUploads += image->tileset->numTile;
+    return TRUE;
+}
+
+void VDP_setHorizontalScrollTile(VDPPlane plane, u16 tile, s16 *values, u16 len, TransferMethod tm)
+{
+    if (tm == DMA_QUEUE)
+        HostStub_Queue(len * 2);
+}
+
+u16 VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm)
+{
+    hostCounters.tileUploads += tileset->numTile;
+
+    if (tm == DMA_QUEUE)
+        HostStub_Queue(tileset->numTile * 32);
+    return TRUE;
+}
+
+void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm)
+{
+    hostCounters.tileUploads += num;
+
+    if (tm == DMA_QUEUE)
+        HostStub_Queue(num * 32);
+}
+
+bool VDP_setTileMapEx(VDPPlane plane, const TileMap *tilemap, u16 basetile, u16 x, u16 y, u16 xm, u16 ym, u16 wm,
+                      u16 hm, TransferMethod tm)
+{
+    if (tm == DMA_QUEUE)
+        HostStub_Queue(wm * hm * 2);
+    return TRUE;
+}
+
+void VDP_setEnable(bool value)
+{
+}
+
+// Plane A at 0xC000, plane B at 0xE000, window at 0xB000, 64 tile wide planes
+u16 VDP_getPlaneAddress(VDPPlane plane, u16 x, u16 y)
+{
+    static const u16 base[] = {0xE000, 0xC000, 0xB000};
+    return base[plane] + (x + y * 64) * 2;
+}
+
+void VDP_setBackgroundColor(u16 value)
+{
+}
+
+void VDP_setTextPalette(u16 palette)
+{
+}
+
+void VDP_setWindowOnBottom(u16 value)
+{
+}
+
+void VDP_setTextPlane(VDPPlane plane)
+{
+}
+
+bool DMA_queueDma(DMAOpType location, void *from, u16 to, u16 len, u16 step)
+{
+    HostStub_Queue(len * 2);
+    return TRUE;
+}
+
+void DMA_flushQueue()
+{
+    queueSize = 0;
+    queueBytes = 0;
+}
+
+u16 DMA_getQueueSize()
+{
+    return queueSize;
+}
+
+u32 DMA_getQueueTransferSize()
+{
+    return queueBytes;
+}
+
+// --- Sprite engine ---
+
+// Switch to a frame and let SPR_update report the change
+static void HostStub_SetFrame(Sprite *sprite, s16 frame)
+{
+    sprite->frameInd = frame;
+    sprite->frame = sprite->animation->frames[frame];
+    sprite->timer = sprite->frame->timer;
+    sprite->status |= SPR_FRAME_CHANGED;
+    sprite->status &= ~SPR_ANIM_DONE;
+}
+
+void SPR_initEx(u16 vramSize)
+{
+    memset(sprites, 0, sizeof(sprites));
+}
+
+Sprite *SPR_addSprite(const SpriteDefinition *spriteDef, s16 x, s16 y, u16 attribut)
+{
+    return SPR_addSpriteEx(spriteDef, x, y, attribut, SPR_FLAG_AUTO_VISIBILITY | SPR_FLAG_AUTO_SPRITE_ALLOC |
+                                                      SPR_FLAG_AUTO_TILE_UPLOAD);
+}
+
+Sprite *SPR_addSpriteEx(const SpriteDefinition *spriteDef, s16 x, s16 y, u16 attribut, u16 flag)
+{
+    for (u16 i = 0; i < MAX_SPRITES; i++)
+    {
+        Sprite *sprite = &sprites[i];
+
+        if (sprite->status & SPR_USED)
+            continue;
+
+        memset(sprite, 0, sizeof(Sprite));
+        sprite->status = SPR_USED;
+        sprite->definition = spriteDef;
+        sprite->attribut = attribut;
+        sprite->x = x;
+        sprite->y = y;
+        sprite->animation = spriteDef->animations[0];
+        HostStub_SetFrame(sprite, 0);
+        hostCounters.spritesAdded++;
+        return sprite;
+    }
+
+    return NULL;
+}
+
+void SPR_releaseSprite(Sprite *sprite)
+{
+    sprite->status = 0;
+}
+
+void SPR_setPosition(Sprite *sprite, s16 x, s16 y)
+{
+    sprite->x = x;
+    sprite->y = y;
+}
+
+void SPR_setVisibility(Sprite *sprite, SpriteVisibility value)
+{
+    sprite->visibility = value;
+}
+
+void SPR_setPalette(Sprite *sprite, u16 value)
+{
+    sprite->attribut = (sprite->attribut & ~TILE_ATTR(3, 0, 0, 0)) | TILE_ATTR(value, 0, 0, 0);
+}
+
+void SPR_setAlwaysOnTop(Sprite *sprite)
+{
+}
+
+void SPR_setAnim(Sprite *sprite, s16 anim)
+{
+    if (sprite->animInd == anim)
+        return;
+
+    SPR_setAnimAndFrame(sprite, anim, 0);
+}
+
+void SPR_setFrame(Sprite *sprite, s16 frame)
+{
+    if (sprite->frameInd != frame)
+        HostStub_SetFrame(sprite, frame);
+}
+
+void SPR_setAnimAndFrame(Sprite *sprite, s16 anim, s16 frame)
+{
+    sprite->animInd = anim;
+    sprite->animation = sprite->definition->animations[anim];
+    HostStub_SetFrame(sprite, frame);
+}
+
+void SPR_setAnimationLoop(Sprite *sprite, bool value)
+{
+    if (value)
+        sprite->status &= ~SPR_NO_LOOP;
+    else
+        sprite->status |= SPR_NO_LOOP;
+}
+
+bool SPR_isAnimationDone(Sprite *sprite)
+{
+    return (sprite->status & SPR_ANIM_DONE) != 0;
+}
+
+void SPR_setFrameChangeCallback(Sprite *sprite, void (*callback)(Sprite *sprite))
+{
+    sprite->onFrameChange = callback;
+}
+
+bool SPR_setVRAMTileIndex(Sprite *sprite, s16 value)
+{
+    sprite->attribut = (sprite->attribut & ~0x07FF) | value;
+    return TRUE;
+}
+
+u16 **SPR_loadAllFrames(const SpriteDefinition *sprDef, u16 index, u16 *totalNumTile)
+{
+    u16 **result = HostStub_Alloc(sprDef->numAnimation * sizeof(u16 *), FALSE);
+    u16 tile = index;
+
+    for (u16 anim = 0; anim < sprDef->numAnimation; anim++)
+    {
+        const Animation *animation = sprDef->animations[anim];
+        result[anim] = HostStub_Alloc(animation->numFrame * sizeof(u16), FALSE);
+
+        for (u16 frame = 0; frame < animation->numFrame; frame++)
+        {
+            result[anim][frame] = tile;
+            tile += VDP_loadTileSet(animation->frames[frame]->tileset, tile, DMA) ?
+                    animation->frames[frame]->tileset->numTile : 0;
+        }
+    }
+
+    if (totalNumTile)
+        *totalNumTile = tile - index;
+    return result;
+}
+
+// Advance animations and report frame changes like the sprite engine does
+void SPR_update()
+{
+    u16 used = 0;
+    hostCounters.spriteUpdates++;
+
+    for (u16 i = 0; i < MAX_SPRITES; i++)
+    {
+        Sprite *sprite = &sprites[i];
+
+        if (!(sprite->status & SPR_USED))
+            continue;
+        used++;
+
+        // Timer 0 means a still frame
+        if (sprite->timer && --sprite->timer == 0)
+        {
+            s16 next = sprite->frameInd + 1;
+
+            if (next < sprite->animation->numFrame)
+                HostStub_SetFrame(sprite, next);
+            else if (!(sprite->status & SPR_NO_LOOP))
+                HostStub_SetFrame(sprite, 0);
+            else
+                sprite->status |= SPR_ANIM_DONE;
+        }
+
+        if (sprite->status & SPR_FRAME_CHANGED)
+        {
+            sprite->status &= ~SPR_FRAME_CHANGED;
+            hostCounters.frameChanges++;
+
+            if (sprite->onFrameChange)
+                sprite->onFrameChange(sprite);
+        }
+    }
+
+    // The sprite table, 8 bytes per hardware sprite
+    if (used)
+        HostStub_Queue(used * 8);
+}
+
+// --- Object pools, same allocation order as the SGDK pool ---
+
+Pool *POOL_create(u16 size, u16 objectSize)
+{
+    Pool *pool = HostStub_Alloc(sizeof(Pool), FALSE);
+
+    pool->bank = HostStub_Alloc(size * objectSize, FALSE);
+    // One spare entry: pool iteration reads one pointer past the last object
+    pool->allocStack = HostStub_Alloc((size + 1) * sizeof(void *), TRUE);
+    pool->size = size;
+    pool->objectSize = objectSize;
+    POOL_reset(pool, TRUE);
+    return pool;
+}
+
+void POOL_reset(Pool *pool, bool clear)
+{
+    u8 *object = pool->bank;
+
+    if (clear)
+        memset(pool->bank, 0, pool->size * pool->objectSize);
+
+    for (u16 i = 0; i < pool->size; i++)
+    {
+        pool->allocStack[i] = object;
+        object += pool->objectSize;
+    }
+
+    pool->free = &pool->allocStack[pool->size];
+}
+
+void *POOL_allocate(Pool *pool)
+{
+    if (pool->free == pool->allocStack)
+    {
+        hostCounters.poolFailures++;
+        return NULL;
+    }
+
+    hostCounters.poolAllocs++;
+    return *--pool->free;
+}
+
+// Allocated objects live at [free, size), releasing keeps their order
+void POOL_release(Pool *pool, void *object, bool maintainCoherency)
+{
+    void **end = &pool->allocStack[pool->size];
+    void **slot = pool->free;
+
+    while (slot < end && *slot != object)
+        slot++;
+
+    if (slot == end)
+        return;
+
+    hostCounters.poolReleases++;
+
+    if (maintainCoherency)
+        memmove(pool->free + 1, pool->free, (slot - pool->free) * sizeof(void *));
+    else
+        *slot = *pool->free;
+
+    *pool->free++ = object;
+}
+
+u16 POOL_getFree(Pool *pool)
+{
+    return pool->free - pool->allocStack;
+}
+
+u16 POOL_getNumAllocated(Pool *pool)
+{
+    return pool->size - POOL_getFree(pool);
+}
+
+void **POOL_getFirst(Pool *pool)
+{
+    return pool->free;
+}
+
+// --- Memory ---
+
+void *MEM_alloc(u16 size)
+{
+    hostCounters.memAllocs++;
+    return HostStub_Alloc(size, FALSE);
+}
+
+void MEM_free(void *ptr)
+{
+    HostStub_Free(ptr);
+}
+
+// Unpacked tiles follow the tile set in one block like on the console, no data to decode
+TileSet *unpackTileSet(const TileSet *src, TileSet *dest)
+{
+    TileSet *result = dest ? dest : MEM_alloc(sizeof(TileSet) + src->numTile * 32);
+
+    result->compression = COMPRESSION_NONE;
+    result->numTile = src->numTile;
+    if (!dest)
+        result->tiles = (u32 *) (result + 1);
+    memset(result->tiles, 0, src->numTile * 32);
+    return result;
+}
+
+TileMap *unpackTileMap(const TileMap *src, TileMap *dest)
+{
+    TileMap *result = dest ? dest : MEM_alloc(sizeof(TileMap) + src->w * src->h * 2);
+
+    result->compression = COMPRESSION_NONE;
+    result->w = src->w;
+    result->h = src->h;
+    if (!dest)
+        result->tilemap = (u16 *) (result + 1);
+    memset(result->tilemap, 0, src->w * src->h * 2);
+    return result;
+}
+
+void memsetU16(u16 *to, u16 value, u16 len)
+{
+    while (len--)
+        *to++ = value;
+}
+
+void memcpyU16(u16 *to, const u16 *from, u16 len)
+{
+    memmove(to, from, len * 2);
+}
+
+// --- Joypad ---
+
+void JOY_init()
+{
+    joypads[0] = 0;
+    joypads[1] = 0;
+}
+
+void JOY_update()
+{
+}
+
+u16 JOY_readJoypad(u16 joy)
+{
+    return joypads[joy];
+}
+
+// --- Sound ---
+
+void Z80_loadDriver(u16 driver, bool waitReady)
+{
+}
+
+void XGM2_play(const u8 *song)
+{
+}
+
+void XGM2_load_FAR(const u8 *song, u32 size)
+{
+}
+
+void XGM2_playTrack(u16 track)
+{
+}
+
+void XGM2_fadeOutAndStop(u16 numFrame)
+{
+}
+
+u16 XGM2_getCPULoad(bool mean)
+{
+    return 0;
+}
+
+void XGM2_playPCM(const u8 *sample, u32 len, SoundPCMChannel channel)
+{
+    hostCounters.pcmTriggers++;
+}
+
+void XGM2_playPCMEx(const u8 *sample, u32 len, SoundPCMChannel channel, u8 priority, bool halfRate, bool loop)
+{
+    hostCounters.pcmTriggers++;
+}
+
+// --- SRAM, word and long values are big endian like on the console ---
+
+void SRAM_enable()
+{
+}
+
+void SRAM_enableRO()
+{
+}
+
+void SRAM_disable()
+{
+}
+
+u8 SRAM_readByte(u32 offset)
+{
+    return sram[offset & (SRAM_SIZE - 1)];
+}
+
+u16 SRAM_readWord(u32 offset)
+{
+    return (SRAM_readByte(offset) << 8) | SRAM_readByte(offset + 1);
+}
+
+u32 SRAM_readLong(u32 offset)
+{
+    return ((u32) SRAM_readWord(offset) << 16) | SRAM_readWord(offset + 2);
+}
+
+void SRAM_writeByte(u32 offset, u8 value)
+{
+    sram[offset & (SRAM_SIZE - 1)] = value;
+}
+
+void SRAM_writeWord(u32 offset, u16 value)
+{
+    SRAM_writeByte(offset, value >> 8);
+    SRAM_writeByte(offset + 1, value);
+}
+
+void SRAM_writeLong(u32 offset, u32 value)
+{
+    SRAM_writeWord(offset, value >> 16);
+    SRAM_writeWord(offset + 2, value);
+}
+
+// --- System ---
+
+void SYS_setVIntCallback(VoidCallback *callback)
+{
+    vintCallback = callback;
+}
+
+void SYS_disableInts()
+{
+}
+
+void SYS_enableInts()
+{
+}
+
+void SYS_hardReset()
+{
+}
+
+u32 SYS_getFPS()
+{
+    return hostPalSystem ? 50 : 60;
+}
+
+u16 SYS_getCPULoad()
+{
+    return cpuLoad;
+}
+
+void kprintf(const char *fmt, ...)
+{
+    va_list args;
+
+    if (!verbose)
+        return;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
@@ -0,0 +1,766 @@
+// Soak harness: boots the ROM headless on the Musashi 68000 core with a minimal VDP
+// and I/O model and runs the stress scenarios of src/soak.c. A ROM built with
+// SOAK_BUILD writes profiler markers to VDP register 0x1C, the harness stamps each
+// with the executed 68000 cycle count and reports exact cycles per stage and frame.
+// V-Int handler cycles are counted apart and taken out of the stage they interrupted.
+//
+// The VDP model keeps registers, status, HV counter and V-Int timing only. DMA moves
+// no data, 68000 to VDP transfers stall the CPU by the bandwidth of the line they
+// start on. There is no Z80, a SOAK_BUILD ROM plays no sound.
+//
+// Usage: soak rom.bin [--frames n] [--warmup n] [--pal] [--scenario name]
+//                     [--out file] [--frames-out file] [--baseline file] [--tolerance percent]
+//                     [--verbose]
+//
+// --out writes the summary table, --frames-out one row per frame, both tab separated.
+// --baseline compares the mean cycles with a summary written before and fails when a
+// metric got slower than the tolerance allows.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "m68k.h"
+#include "profiler.h"
+#include "soak.h"
+
+#define DEFAULT_FRAMES          1800
+#define DEFAULT_WARMUP          120
+#define DEFAULT_TOLERANCE       2       // Percent, the emulation is deterministic
+
+#define LINE_MASTER_CLOCKS      3420    // 68000 runs at master clock / 7
+#define CPU_CLOCK_DIVIDER       7
+#define VINT_LINE               224
+#define WATCHDOG_FRAMES         60      // Video frames without a frame marker
+
+#define VDP_REG_MARKER          0x1C    // Unused register, profiler markers
+#define VDP_REG_KDEBUG          0x1F    // Gens KMod debug text
+
+// Metrics after the profiler stages
+enum
+{
+    METRIC_VINT = PROF_STAGE_COUNT,
+    METRIC_BUSY,                        // Stages and V-Int
+    METRIC_FRAME,                       // Frame marker to frame marker, idle wait included
+    METRIC_DMA_BYTES,
+    METRIC_COUNT
+};
+
+static const char *const metricNames[METRIC_COUNT] = {
+    "input", "player", "projectile", "enemies", "explosions", "collision", "spawner", "render",
+    "vint", "busy", "frame", "dma_bytes"
+};
+
+static const char *const scenarioNames[SOAK_SCENARIO_COUNT] = {
+    [SOAK_FIRE] = "fire",
+    [SOAK_WAVE_HOR] = "wave_hor",
+    [SOAK_WAVE_SIN] = "wave_sin",
+    [SOAK_EXPLOSIONS] = "explosions",
+};
+
+typedef struct
+{
+    const char *romPath;
+    u32 frames;
+    u32 warmup;
+    bool pal;
+    s16 scenario;                       // -1 runs all
+    const char *outPath;
+    const char *framesOutPath;
+    const char *baselinePath;
+    u16 tolerance;
+    bool verbose;
+} HarnessConfig;
+
+typedef struct
+{
+    unsigned long long sum;
+    u32 min;
+    u32 max;
+} HarnessMetric;
+
+// Minimal VDP: registers, command latch and interrupt state
+typedef struct
+{
+    u8 regs[32];
+    bool commandPending;
+    u16 commandFirst;
+    bool vintPending;
+    bool irqRaised;
+    u32 dmaBytes;
+} HarnessVDP;
+
+// Machine state of one scenario run
+typedef struct
+{
+    u8 ram[0x10000];
+    u8 sram[0x10000];
+    u8 z80Ram[0x2000];
+    bool sramEnabled;
+    u8 padTH[2];                        // Last value written to the pad data ports
+    u16 pads[2];
+    HarnessVDP vdp;
+
+    unsigned long long clock;           // Timeline in 68000 cycles, DMA stalls included
+    unsigned long long cycles;          // Executed 68000 cycles
+    unsigned long long stall;           // DMA stall of the running slice
+
+    // Marker accounting of the current frame
+    s16 openStage;
+    unsigned long long stageStart;
+    unsigned long long vintInStage;
+    unsigned long long vintStart;
+    bool inVInt;
+    unsigned long long lastFrameMark;
+    u32 metrics[METRIC_COUNT];          // Frame in progress, starts with the V-Int that released it
+    u32 frame[METRIC_COUNT];            // Last finished frame
+    u32 frameMarks;
+} HarnessMachine;
+
+static u8 *rom;
+static u32 romSize;
+static u32 vintVector;
+static u16 linesPerFrame;
+static HarnessConfig config;
+static HarnessMachine machine;
+static HarnessMetric results[SOAK_SCENARIO_COUNT][METRIC_COUNT];
+static FILE *framesOut;
+static char kdebugLine[256];
+static u16 kdebugLength;
+
+
+// Executed cycles at this point of the running slice
+static unsigned long long Harness_Now()
+{
+    return machine.cycles + m68k_cycles_run();
+}
+
+// Position in the frame in master clocks
+static u32 Harness_FrameClock()
+{
+    unsigned long long clocks = (machine.clock + m68k_cycles_run() + machine.stall) * CPU_CLOCK_DIVIDER;
+    return clocks % ((unsigned long long) LINE_MASTER_CLOCKS * linesPerFrame);
+}
+
+static u16 Harness_Line()
+{
+    return Harness_FrameClock() / LINE_MASTER_CLOCKS;
+}
+
+// V counter as the VDP reports it, jumping back over the lines that do not fit 8 bits
+static u16 Harness_VCounter(u16 line)
+{
+    if (!config.pal)
+        return line <= 0xEA ? line : line - 6;
+    return line <= 0x102 ? line & 0xFF : (line - 57) & 0xFF;
+}
+
+// --- Profiler markers ---
+
+static void Harness_Marker(u8 value)
+{
+    unsigned long long now = Harness_Now();
+
+    if (value == PROFILER_SOAK_VINT_END)
+    {
+        if (!machine.inVInt)
+            return;
+        u32 spent = now - machine.vintStart;
+        machine.metrics[METRIC_VINT] += spent;
+        if (machine.openStage >= 0)
+            machine.vintInStage += spent;
+        machine.inVInt = FALSE;
+    }
+    else if (value == PROFILER_SOAK_FRAME)
+    {
+        u32 busy = machine.metrics[METRIC_VINT];
+        for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+            busy += machine.metrics[i];
+
+        machine.metrics[METRIC_BUSY] = busy;
+        machine.metrics[METRIC_FRAME] = now - machine.lastFrameMark;
+        machine.metrics[METRIC_DMA_BYTES] = machine.vdp.dmaBytes;
+        memcpy(machine.frame, machine.metrics, sizeof(machine.frame));
+
+        memset(machine.metrics, 0, sizeof(machine.metrics));
+        machine.vdp.dmaBytes = 0;
+        machine.lastFrameMark = now;
+        machine.frameMarks++;
+    }
+    else if (value & PROFILER_SOAK_END)
+    {
+        u16 stage = value & ~PROFILER_SOAK_END;
+        if (stage < PROF_STAGE_COUNT && machine.openStage == stage)
+            machine.metrics[stage] += now - machine.stageStart - machine.vintInStage;
+        machine.openStage = -1;
+    }
+    else if (value < PROF_STAGE_COUNT)
+    {
+        machine.openStage = value;
+        machine.stageStart = now;
+        machine.vintInStage = 0;
+    }
+}
+
+// Gens KMod text output, one character per register write
+static void Harness_KDebug(u8 value)
+{
+    if (value && kdebugLength < sizeof(kdebugLine) - 1)
+    {
+        kdebugLine[kdebugLength++] = value;
+        return;
+    }
+
+    kdebugLine[kdebugLength] = 0;
+    if (config.verbose)
+        fprintf(stderr, "kdebug: %s\n", kdebugLine);
+    kdebugLength = 0;
+}
+
+// --- VDP ---
+
+static void Harness_VDPControl(u16 value)
+{
+    HarnessVDP *vdp = &machine.vdp;
+
+    if (vdp->commandPending)
+    {
+        vdp->commandPending = FALSE;
+
+        // CD5 starts a DMA when DMA is enabled in register 1
+        if ((value & 0x80) && (vdp->regs[1] & 0x10))
+        {
+            u32 words = vdp->regs[0x13] | (vdp->regs[0x14] << 8);
+            if (!words)
+                words = 0x10000;
+            vdp->dmaBytes += words * 2;
+
+            // Memory to VDP freezes the 68000, about 102 words per line in vblank and 9 in the display
+            if (!(vdp->regs[0x17] & 0x80))
+            {
+                u16 line = Harness_Line();
+                bool blank = line >= VINT_LINE || !(vdp->regs[1] & 0x40);
+                machine.stall += (unsigned long long) words * LINE_MASTER_CLOCKS / CPU_CLOCK_DIVIDER / (blank ? 102 : 9);
+                m68k_end_timeslice();
+            }
+        }
+        return;
+    }
+
+    if ((value & 0xC000) == 0x8000)
+    {
+        u16 reg = (value >> 8) & 0x1F;
+        vdp->regs[reg] = value & 0xFF;
+
+        if (reg == VDP_REG_MARKER)
+            Harness_Marker(value & 0xFF);
+        else if (reg == VDP_REG_KDEBUG)
+            Harness_KDebug(value & 0xFF);
+        return;
+    }
+
+    vdp->commandFirst = value;
+    vdp->commandPending = TRUE;
+}
+
+static u16 Harness_VDPRead(u32 address)
+{
+    u32 frameClock = Harness_FrameClock();
+    u16 line = frameClock / LINE_MASTER_CLOCKS;
+    u16 hclock = frameClock % LINE_MASTER_CLOCKS;
+
+    switch (address & 0x1C)
+    {
+        case 0x04:
+        {
+            HarnessVDP *vdp = &machine.vdp;
+            vdp->commandPending = FALSE;
+            return 0x3400 | 0x0200 | (vdp->vintPending ? 0x80 : 0) |
+                   (line >= VINT_LINE || !(vdp->regs[1] & 0x40) ? 0x08 : 0) |
+                   (hclock >= LINE_MASTER_CLOCKS - 344 ? 0x04 : 0) | (config.pal ? 0x01 : 0);
+        }
+
+        case 0x08:
+            return (Harness_VCounter(line) << 8) | (hclock * 210 / LINE_MASTER_CLOCKS);
+
+        default:
+            return 0;
+    }
+}
+
+// --- Pads and I/O ---
+
+// 3 button pad, TH high gives C B Right Left Down Up, TH low Start A 0 0 Down Up, active low
+static u8 Harness_PadRead(u16 port)
+{
+    u16 buttons = machine.pads[port];
+    u8 th = machine.padTH[port] & 0x40;
+    u8 value;
+
+    if (th)
+        value = (buttons & 0x0F) | ((buttons & BUTTON_B) ? 0x10 : 0) | ((buttons & BUTTON_C) ? 0x20 : 0);
+    else
+        value = (buttons & 0x03) | ((buttons & BUTTON_A) ? 0x10 : 0) | ((buttons & BUTTON_START) ? 0x20 : 0) | 0x0C;
+
+    return th | (~value & 0x3F);
+}
+
+static u8 Harness_IORead(u32 address)
+{
+    switch (address & 0x1F)
+    {
+        case 0x01:
+            // Overseas model without TMSS
+            return config.pal ? 0xE0 : 0xA0;
+        case 0x03:
+            return Harness_PadRead(0);
+        case 0x05:
+            return Harness_PadRead(1);
+        default:
+            return 0;
+    }
+}
+
+static void Harness_IOWrite(u32 address, u8 value)
+{
+    if ((address & 0x1F) == 0x03)
+        machine.padTH[0] = value;
+    else if ((address & 0x1F) == 0x05)
+        machine.padTH[1] = value;
+}
+
+// --- Musashi memory callbacks ---
+
+static u8 Harness_Read8(u32 address)
+{
+    address &= 0xFFFFFF;
+
+    if (address < 0x400000)
+    {
+        // 16-bit SRAM answers on the odd byte lane
+        if (machine.sramEnabled && address >= 0x200000 && address < 0x220000)
+            return (address & 1) ? machine.sram[(address - 0x200000) >> 1] : 0xFF;
+        return address < romSize ? rom[address] : 0xFF;
+    }
+    if (address >= 0xE00000)
+        return machine.ram[address & 0xFFFF];
+    if (address >= 0xA00000 && address < 0xA04000)
+        return machine.z80Ram[address & 0x1FFF];
+    if (address >= 0xA10000 && address < 0xA10020)
+        return Harness_IORead(address);
+    if (address >= 0xC00000 && address < 0xC00020)
+    {
+        u16 word = Harness_VDPRead(address);
+        return (address & 1) ? word & 0xFF : word >> 8;
+    }
+
+    // Z80 bus always granted, YM2612 never busy
+    return 0;
+}
+
+static void Harness_Write8(u32 address, u8 value)
+{
+    address &= 0xFFFFFF;
+
+    if (address >= 0xE00000)
+        machine.ram[address & 0xFFFF] = value;
+    else if (address >= 0x200000 && address < 0x220000)
+    {
+        if (machine.sramEnabled && (address & 1))
+            machine.sram[(address - 0x200000) >> 1] = value;
+    }
+    else if (address >= 0xA00000 && address < 0xA04000)
+        machine.z80Ram[address & 0x1FFF] = value;
+    else if (address >= 0xA10000 && address < 0xA10020)
+        Harness_IOWrite(address, value);
+    else if (address == 0xA130F1)
+        machine.sramEnabled = value & 1;
+    else if (address >= 0xC00004 && address < 0xC00008)
+        Harness_VDPControl(value | (value << 8));
+}
+
+static void Harness_Write16(u32 address, u16 value)
+{
+    address &= 0xFFFFFF;
+
+    if (address >= 0xC00000 && address < 0xC00020)
+    {
+        // Data port writes only feed DMA fills, which move no data here
+        if ((address & 0x1C) == 0x04)
+            Harness_VDPControl(value);
+        return;
+    }
+
+    Harness_Write8(address, value >> 8);
+    Harness_Write8(address + 1, value & 0xFF);
+}
+
+unsigned int m68k_read_memory_8(unsigned int address)
+{
+    return Harness_Read8(address);
+}
+
+unsigned int m68k_read_memory_16(unsigned int address)
+{
+    if ((address & 0xFFFFE0) == 0xC00000)
+        return Harness_VDPRead(address);
+    return (Harness_Read8(address) << 8) | Harness_Read8(address + 1);
+}
+
+unsigned int m68k_read_memory_32(unsigned int address)
+{
+    return (m68k_read_memory_16(address) << 16) | m68k_read_memory_16(address + 2);
+}
+
+void m68k_write_memory_8(unsigned int address, unsigned int value)
+{
+    Harness_Write8(address, value);
+}
+
+void m68k_write_memory_16(unsigned int address, unsigned int value)
+{
+    Harness_Write16(address, value);
+}
+
+void m68k_write_memory_32(unsigned int address, unsigned int value)
+{
+    Harness_Write16(address, value >> 16);
+    Harness_Write16(address + 2, value & 0xFFFF);
+}
+
+unsigned int m68k_read_disassembler_8(unsigned int address)
+{
+    return Harness_Read8(address);
+}
+
+unsigned int m68k_read_disassembler_16(unsigned int address)
+{
+    return (Harness_Read8(address) << 8) | Harness_Read8(address + 1);
+}
+
+unsigned int m68k_read_disassembler_32(unsigned int address)
+{
+    return (m68k_read_disassembler_16(address) << 16) | m68k_read_disassembler_16(address + 2);
+}
+
+// --- Machine ---
+
+// Scripted joypad: fire held, vertical sweep, START pulses to join and rejoin
+static u16 Harness_Input(u32 frame, u16 player)
+{
+    u32 phase = (frame + player * 45) % 180;
+    u16 buttons = BUTTON_A;
+
+    buttons |= (phase < 90) ? BUTTON_UP : BUTTON_DOWN;
+    if (frame % 300 == 60 + player * 30)
+        buttons |= BUTTON_START;
+
+    return buttons;
+}
+
+// Run the CPU until the timeline reaches a cycle
+static void Harness_RunUntil(unsigned long long target)
+{
+    while (machine.clock < target)
+    {
+        // Step single instructions while the interrupt waits, to see when it is taken
+        bool waiting = machine.vdp.irqRaised;
+        unsigned long long before = machine.cycles;
+        int done = m68k_execute(waiting ? 1 : (int) (target - machine.clock));
+
+        machine.cycles += done;
+        machine.clock += done + machine.stall;
+        machine.stall = 0;
+
+        // Taken when the handler runs with the interrupt mask raised, exception cycles included
+        u32 pc = m68k_get_reg(NULL, M68K_REG_PC);
+        if (waiting && (m68k_get_reg(NULL, M68K_REG_SR) & 0x0700) >= 0x0600 && pc - vintVector < 16)
+        {
+            m68k_set_irq(0);
+            machine.vdp.irqRaised = FALSE;
+            machine.vdp.vintPending = FALSE;
+            machine.vintStart = before;
+            machine.inVInt = TRUE;
+        }
+    }
+}
+
+// Run one video frame from line 0, V-Int fires on the first line after the display
+static void Harness_RunVideoFrame(u32 frame)
+{
+    unsigned long long start = (unsigned long long) frame * LINE_MASTER_CLOCKS * linesPerFrame;
+
+    Harness_RunUntil((start + VINT_LINE * LINE_MASTER_CLOCKS) / CPU_CLOCK_DIVIDER);
+
+    // Pads are read in the frame that follows
+    machine.pads[0] = Harness_Input(frame, 0);
+    machine.pads[1] = Harness_Input(frame, 1);
+
+    machine.vdp.vintPending = TRUE;
+    if (machine.vdp.regs[1] & 0x20)
+    {
+        machine.vdp.irqRaised = TRUE;
+        m68k_set_irq(6);
+    }
+
+    Harness_RunUntil((start + LINE_MASTER_CLOCKS * linesPerFrame) / CPU_CLOCK_DIVIDER);
+}
+
+// Power on with the scenario in SRAM
+static void Harness_Reset(SoakScenario scenario)
+{
+    memset(&machine, 0, sizeof(machine));
+    machine.openStage = -1;
+    machine.padTH[0] = machine.padTH[1] = 0x40;
+
+    const u8 magic[4] = {SOAK_MAGIC >> 24, (SOAK_MAGIC >> 16) & 0xFF, (SOAK_MAGIC >> 8) & 0xFF, SOAK_MAGIC & 0xFF};
+    memcpy(&machine.sram[SOAK_SRAM_OFFSET], magic, 4);
+    machine.sram[SOAK_SRAM_OFFSET + 4] = 0;
+    machine.sram[SOAK_SRAM_OFFSET + 5] = scenario;
+
+    m68k_pulse_reset();
+}
+
+// Print where the CPU is stuck and give up
+static void Harness_Watchdog(SoakScenario scenario)
+{
+    char text[128];
+    u32 pc = m68k_get_reg(NULL, M68K_REG_PC);
+
+    m68k_disassemble(text, pc, M68K_CPU_TYPE_68000);
+    fprintf(stderr, "%s: no frame marker for %d frames, pc %06x: %s\n", scenarioNames[scenario], WATCHDOG_FRAMES, pc,
+            text);
+    fprintf(stderr, "is the ROM built with SOAK_BUILD?\n");
+    exit(1);
+}
+
+static void Harness_RunScenario(SoakScenario scenario)
+{
+    HarnessMetric *metrics = results[scenario];
+    u32 videoFrame = 0;
+    u32 lastMarks = 0;
+    u32 stalled = 0;
+
+    for (u16 i = 0; i < METRIC_COUNT; i++)
+    {
+        metrics[i].sum = 0;
+        metrics[i].min = ~0;
+        metrics[i].max = 0;
+    }
+
+    Harness_Reset(scenario);
+
+    while (machine.frameMarks < config.warmup + config.frames)
+    {
+        Harness_RunVideoFrame(videoFrame++);
+
+        stalled = machine.frameMarks == lastMarks ? stalled + 1 : 0;
+        if (stalled == WATCHDOG_FRAMES)
+            Harness_Watchdog(scenario);
+
+        // A game frame ended during this video frame
+        if (machine.frameMarks != lastMarks)
+        {
+            lastMarks = machine.frameMarks;
+
+            if (machine.frameMarks > config.warmup)
+            {
+                for (u16 i = 0; i < METRIC_COUNT; i++)
+                {
+                    u32 value = machine.frame[i];
+                    metrics[i].sum += value;
+                    metrics[i].min = min(metrics[i].min, value);
+                    metrics[i].max = max(metrics[i].max, value);
+                }
+
+                if (framesOut)
+                {
+                    fprintf(framesOut, "%s\t%u", scenarioNames[scenario], machine.frameMarks - config.warmup - 1);
+                    for (u16 i = 0; i < METRIC_COUNT; i++)
+                        fprintf(framesOut, "\t%u", machine.frame[i]);
+                    fprintf(framesOut, "\n");
+                }
+            }
+        }
+    }
+}
+
+// --- Reports ---
+
+static void Harness_WriteSummary(FILE *file)
+{
+    fprintf(file, "scenario\tmetric\tmin\tmean\tmax\n");
+    for (u16 s = SOAK_FIRE; s < SOAK_SCENARIO_COUNT; s++)
+    {
+        if (config.scenario >= 0 && config.scenario != s)
+            continue;
+        for (u16 i = 0; i < METRIC_COUNT; i++)
+            fprintf(file, "%s\t%s\t%u\t%llu\t%u\n", scenarioNames[s], metricNames[i], results[s][i].min,
+                    results[s][i].sum / config.frames, results[s][i].max);
+    }
+}
+
+// Compare the means with a summary written before, returns the number of regressions
+static u16 Harness_CompareBaseline(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[256];
+    u16 regressions = 0;
+
+    if (!file)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), file))
+    {
+        char scenario[64];
+        char metric[64];
+        unsigned int low;
+        unsigned long long mean;
+        unsigned int high;
+
+        if (sscanf(line, "%63s %63s %u %llu %u", scenario, metric, &low, &mean, &high) != 5)
+            continue;
+
+        for (u16 s = SOAK_FIRE; s < SOAK_SCENARIO_COUNT; s++)
+        {
+            if (strcmp(scenario, scenarioNames[s]) || (config.scenario >= 0 && config.scenario != s))
+                continue;
+
+            for (u16 i = 0; i < METRIC_COUNT; i++)
+            {
+                unsigned long long now = results[s][i].sum / config.frames;
+                if (i == METRIC_FRAME || strcmp(metric, metricNames[i]) ||
+                    now * 100 <= mean * (100 + config.tolerance))
+                    continue;
+
+                printf("REGRESSION %s %s: %llu -> %llu cycles\n", scenario, metric, mean, now);
+                regressions++;
+            }
+        }
+    }
+
+    fclose(file);
+    return regressions;
+}
+
+static void Harness_LoadRom(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        exit(1);
+    }
+
+    rom = malloc(0x400000);
+    romSize = fread(rom, 1, 0x400000, file);
+    fclose(file);
+
+    vintVector = (rom[0x78] << 24) | (rom[0x79] << 16) | (rom[0x7A] << 8) | rom[0x7B];
+}
+
+static void Harness_ParseArgs(int argc, char **argv)
+{
+    bool usage = FALSE;
+
+    for (int i = 1; i < argc && !usage; i++)
+    {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            config.frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            config.warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--pal"))
+            config.pal = TRUE;
+        else if (!strcmp(argv[i], "--scenario") && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            for (s16 s = SOAK_FIRE; s < SOAK_SCENARIO_COUNT; s++)
+                if (!strcmp(name, scenarioNames[s]))
+                    config.scenario = s;
+        }
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            config.outPath = argv[++i];
+        else if (!strcmp(argv[i], "--frames-out") && i + 1 < argc)
+            config.framesOutPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+            config.baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+            config.tolerance = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--verbose"))
+            config.verbose = TRUE;
+        else if (argv[i][0] != '-' && !config.romPath)
+            config.romPath = argv[i];
+        else
+            usage = TRUE;
+    }
+
+    if (usage || !config.romPath || !config.frames)
+    {
+        fprintf(stderr, "usage: %s rom.bin [--frames n] [--warmup n] [--pal] [--scenario fire|wave_hor|wave_sin|"
+                        "explosions] [--out file] [--frames-out file] [--baseline file] [--tolerance percent] "
+                        "[--verbose]\n", argv[0]);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    config.frames = DEFAULT_FRAMES;
+    config.warmup = DEFAULT_WARMUP;
+    config.scenario = -1;
+    config.tolerance = DEFAULT_TOLERANCE;
+
+    Harness_ParseArgs(argc, argv);
+    Harness_LoadRom(config.romPath);
+    linesPerFrame = config.pal ? 313 : 262;
+
+    m68k_init();
+    m68k_set_cpu_type(M68K_CPU_TYPE_68000);
+
+    if (config.framesOutPath)
+    {
+        framesOut = fopen(config.framesOutPath, "w");
+        if (!framesOut)
+        {
+            fprintf(stderr, "cannot write %s\n", config.framesOutPath);
+            exit(1);
+        }
+
+        fprintf(framesOut, "scenario\tframe");
+        for (u16 i = 0; i < METRIC_COUNT; i++)
+            fprintf(framesOut, "\t%s", metricNames[i]);
+        fprintf(framesOut, "\n");
+    }
+
+    for (u16 s = SOAK_FIRE; s < SOAK_SCENARIO_COUNT; s++)
+    {
+        if (config.scenario < 0 || config.scenario == s)
+            Harness_RunScenario(s);
+    }
+
+    if (framesOut)
+        fclose(framesOut);
+
+    // 68000 cycles, a video frame has about 128006 on NTSC and 152914 on PAL
+    Harness_WriteSummary(stdout);
+    if (config.outPath)
+    {
+        FILE *file = fopen(config.outPath, "w");
+        if (!file)
+        {
+            fprintf(stderr, "cannot write %s\n", config.outPath);
+            exit(1);
+        }
+        Harness_WriteSummary(file);
+        fclose(file);
+    }
+
+    if (config.baselinePath && Harness_CompareBaseline(config.baselinePath))
+        return 2;
+
+    return 0;
+}
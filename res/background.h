@@ -0,0 +1,15 @@
+// Generated with: tools/tile_optimizer.py res/background res/map.png res/back.png --animate star=res/back.png:11,8,4,4 --animate star=res/back.png:45,8,4,4
+// Do not edit
+
+#ifndef HEADER_BACKGROUND
+#define HEADER_BACKGROUND
+
+#define BACKGROUND_MAP_WIDTH 64
+#define BACKGROUND_MAP_HEIGHT 28
+#define BACKGROUND_BACK_WIDTH 64
+#define BACKGROUND_BACK_HEIGHT 20
+#define BACKGROUND_STAR_TILE 0
+#define BACKGROUND_STAR_TILES 16
+#define BACKGROUND_TILES 709
+
+#endif //HEADER_BACKGROUND
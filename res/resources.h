@@ -1,16 +0,0 @@
-#include <genesis.h>
-
-#ifndef _RES_RESOURCES_H_
-#define _RES_RESOURCES_H_
-
-extern const u8 xpcm_shoot[3072];
-extern const u8 xpcm_explosion[9728];
-extern const u8 xgm2_music[11264];
-extern const Image mapImage;
-extern const Image bgImage;
-extern const SpriteDefinition player_sprite;
-extern const SpriteDefinition enemy_sprite;
-extern const SpriteDefinition bullet_sprite;
-extern const SpriteDefinition explosion_sprite;
-
-#endif // _RES_RESOURCES_H_
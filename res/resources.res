@@ -1,17 +1,36 @@
 
 
 //------------------------------ Background map -----------------------------------------------------
-IMAGE mapImage "map.png" NONE
-IMAGE bgImage "back.png" NONE
+// Codecs by use: APLIB for data unpacked once at load (background tiles, resident sheets),
+// NONE for sheets streamed every frame change, their frames go to VRAM by DMA straight
+// from ROM instead of through a heap buffer. See the asset section of MICROBENCH.
 
-SPRITE player_sprite "player.png" 4 4 NONE 5
-SPRITE enemy_sprite "enemy1.png" 4 4 NONE 0
-SPRITE bullet_sprite "bullet.png" 4 2 NONE 2
-SPRITE explosion_sprite "boom.png" 4 4 NONE 3
+// Both planes share one tile set with repeated and flipped tiles merged, generated from
+// map.png and back.png with the command in background.h. The star tiles of back.png
+// are kept apart for their animation.
+TILESET bgTileset "background_tiles.png" APLIB NONE
+PALETTE bgPalette "background_tiles.png"
+BIN mapTilemapData "background_map.bin" 2
+BIN backTilemapData "background_back.bin" 2
+
+// Tile animations, frames of 4x4 tiles one below the other, sent from ROM as they are
+TILESET anim_star "anim_star.png" NONE NONE
+
+// Explosion and particle sheets are drawn with the enemy palette, colors 12-15 are theirs
+SPRITE player_sprite "player.png" 4 4 APLIB 5
+SPRITE enemy_sprite "enemy1.png" 4 4 APLIB 0
+SPRITE bullet_sprite "bullet.png" 4 2 APLIB 2
+// Streamed, every frame keeps the full 4x4 layout so a slot buffer fits any of them
+SPRITE explosion_sprite "boom.png" 4 4 NONE 3 NONE NONE
+SPRITE particle_sprite "particle.png" 1 1 APLIB 0
 
 
 //------------------------------ Background map -----------------------------------------------------
-WAV xpcm_shoot "sounds/shoot.wav" XGM
-WAV xpcm_explosion "sounds/explosion.wav" XGM
+// Mono, silence trimmed, from the originals in sounds/ with:
+//   tools/pcm_pipeline.py res/sounds/shoot.wav res/sounds/explosion.wav --out res/sounds/trimmed
+// Both keep the 13300 Hz driver rate, neither holds 20 dB at the 6650 Hz half rate
+WAV xpcm_shoot "sounds/trimmed/shoot.wav" XGM2
+WAV xpcm_explosion "sounds/trimmed/explosion.wav" XGM2
 
-XGM2 xgm2_music "sounds/03 - Back to the Fire (Stage 1 - Hydra).vgm"
+// Stage tracks as one multi-track song, in the order of MusicTrack in music.h
+XGM2 xgm2_music "sounds/03 - Back to the Fire (Stage 1 - Hydra).vgm" "sounds/03 - Knights of Legend (Stage 1A).vgm" "sounds/07 - Space Walk (Stage 2A).vgm" "sounds/14 - Hunger Made Them Desperate (Stage 7 - Orn Base).vgm"
@@ -0,0 +1,160 @@
+// Session arena. All gameplay memory, players, object pools and the collision grid, is
+// taken in order from one static block and given back at once when a session starts,
+// so the SGDK heap never fragments and the block size is the whole RAM budget of the
+// game state. The report adds the static game state and the stack headroom: at reset
+// the stack below the Game_Init frame is filled with a pattern, the deepest call since
+// then is where the pattern ends.
+//
+
+#include <genesis.h>
+#include "arena.h"
+#include "defs.h"
+#include "globals.h"
+
+// Blocks start on 4 byte boundaries, even for the 68000 and pointer aligned on the host
+#define ARENA_ALIGN(size)       (((size) + 3) & ~3)
+
+static GAME_TLS u32 data[ARENA_SIZE / 4];
+static GAME_TLS u16 used = 0;
+static GAME_TLS u16 peak = 0;
+static GAME_TLS u16 tagBytes[ARENA_TAG_COUNT];
+
+#if !HOST_BUILD
+static u16 *stackBottom = NULL;
+static u16 *stackTop = NULL;
+#endif
+
+static const char *const tagNames[ARENA_TAG_COUNT] = {
+    [ARENA_PLAYERS] = "players",
+    [ARENA_ENEMIES] = "enemies",
+    [ARENA_PROJECTILES] = "projectiles",
+    [ARENA_EXPLOSIONS] = "explosions",
+    [ARENA_GRID] = "grid",
+};
+
+
+#if !HOST_BUILD
+// Fill the checked stack region below the caller with the pattern
+static void Arena_PaintStack()
+{
+    u16 *sp = (u16 *) __builtin_frame_address(0);
+
+    // The vblank handler runs on this stack, it must not push into the words being written
+    SYS_disableInts();
+    stackTop = sp - ARENA_STACK_MARGIN / 2;
+    stackBottom = stackTop - ARENA_STACK_CHECK / 2;
+    for (u16 *word = stackBottom; word < stackTop; word++)
+        *word = ARENA_STACK_PATTERN;
+    SYS_enableInts();
+}
+#endif
+
+// Give back everything of the last session and mark the stack
+void Arena_Reset()
+{
+    used = 0;
+    peak = 0;
+    memsetU16(tagBytes, 0, ARENA_TAG_COUNT);
+
+#if !HOST_BUILD
+    if (!stackBottom)
+        Arena_PaintStack();
+#endif
+}
+
+// Take zeroed memory for the session, NULL when the arena is full
+void *Arena_Alloc(ArenaTag tag, u16 size)
+{
+    u16 bytes = ARENA_ALIGN(size);
+    void *block;
+
+    if (bytes > ARENA_SIZE - used)
+    {
+        kprintf("Arena: %u bytes for %s do not fit, %u of %u used", size, tagNames[tag], used, ARENA_SIZE);
+        return NULL;
+    }
+
+    block = (u8 *) data + used;
+    memset(block, 0, bytes);
+    used += bytes;
+    tagBytes[tag] += bytes;
+    if (used > peak)
+        peak = used;
+
+    return block;
+}
+
+// Object pool in the arena, laid out and reset like POOL_create does it on the heap
+Pool *Arena_CreatePool(ArenaTag tag, u16 size, u16 objectSize)
+{
+    Pool *pool = Arena_Alloc(tag, sizeof(Pool));
+
+    if (!pool)
+        return NULL;
+
+    pool->bank = Arena_Alloc(tag, size * objectSize);
+    // One spare entry: pool iteration reads one pointer past the last object
+    pool->allocStack = Arena_Alloc(tag, (size + 1) * sizeof(void *));
+    if (!pool->bank || !pool->allocStack)
+        return NULL;
+
+    pool->size = size;
+    pool->objectSize = objectSize;
+    POOL_reset(pool, FALSE);
+    return pool;
+}
+
+// Bytes handed out this session
+u16 Arena_GetUsed()
+{
+    return used;
+}
+
+// Most bytes handed out at once this session
+u16 Arena_GetPeak()
+{
+    return peak;
+}
+
+// Bytes handed out to one owner this session
+u16 Arena_GetTagBytes(ArenaTag tag)
+{
+    return tagBytes[tag];
+}
+
+// Get the printable name of an owner
+const char *Arena_GetTagName(ArenaTag tag)
+{
+    return tagNames[tag];
+}
+
+// Bytes of the checked stack region never reached, zero on the host
+u16 Arena_GetStackHeadroom()
+{
+#if HOST_BUILD
+    return 0;
+#else
+    u16 *word = stackBottom;
+
+    if (!word)
+        return 0;
+    while (word < stackTop && *word == ARENA_STACK_PATTERN)
+        word++;
+    return (word - stackBottom) * 2;
+#endif
+}
+
+// Print the arena use per owner, the static state and the stack headroom to the debug log
+void Arena_Report()
+{
+    kprintf("RAM: arena %u of %u bytes, peak %u", used, ARENA_SIZE, peak);
+
+    for (u16 i = 0; i < ARENA_TAG_COUNT; i++)
+        kprintf("  %s: %u bytes", tagNames[i], tagBytes[i]);
+
+    kprintf("  static game state: %u bytes", (u16) sizeof(GameState));
+#if !HOST_BUILD
+    kprintf("  stack headroom: %u of %u bytes below Game_Init", Arena_GetStackHeadroom(), ARENA_STACK_CHECK);
+    kprintf("  SGDK heap free: %u bytes", MEM_getFree());
+#endif
+}
@@ -0,0 +1,36 @@
+#ifndef HEADER_ARENA
+#define HEADER_ARENA
+
+#include <genesis.h>
+
+// Owners of arena memory, for the usage report
+typedef enum
+{
+    ARENA_PLAYERS,
+    ARENA_ENEMIES,
+    ARENA_PROJECTILES,
+    ARENA_EXPLOSIONS,
+    ARENA_GRID,
+    ARENA_TAG_COUNT
+} ArenaTag;
+
+
+void Arena_Reset();
+
+void *Arena_Alloc(ArenaTag tag, u16 size);
+
+Pool *Arena_CreatePool(ArenaTag tag, u16 size, u16 objectSize);
+
+u16 Arena_GetUsed();
+
+u16 Arena_GetPeak();
+
+u16 Arena_GetTagBytes(ArenaTag tag);
+
+const char *Arena_GetTagName(ArenaTag tag);
+
+u16 Arena_GetStackHeadroom();
+
+void Arena_Report();
+
+#endif //HEADER_ARENA
@@ -6,11 +6,21 @@
 #define HEADER_DEFS
 
 // Game settings
-#define PLAY_MUSIC                      0
+#define PLAY_MUSIC                      (!SOAK_BUILD)   // The soak harness has no Z80
 #define SHOW_FPS                        1
+#ifndef SOAK_BUILD
+#define SOAK_BUILD                      0      // Build for the soak harness in host/soak
+#endif
+#define PLAY_SFX                        (!SOAK_BUILD)   // The soak harness has no Z80
+#ifndef HOST_THREADS
+#define HOST_THREADS                    0      // Host simulator running sessions on several threads
+#endif
+#ifndef MICROBENCH
+#define MICROBENCH                      0      // Run the kernel microbenchmarks instead of the game
+#endif
 #define BLINK_TICKS                     3
 
-// Game balance
+// Game balance (per-frame values are for 60 Hz, see motion.c for 50 Hz)
 #define BULLET_DAMAGE                   10
 #define BULLET_HP                       2
 #define ENEMY_DAMAGE                    10
@@ -37,20 +47,29 @@
 #define ENEMY_HEIGHT                    24
 #define ENEMY_WIDTH                     24
 #define ENEMY_HP                        10
-#define ENEMY_SCORE_VALUE               10
+#define ENEMY_SCORE_VALUE               0x10 // packed BCD
 #define OBJECT_SIZE                     16
 #define PLAYER_HEIGHT                   24
 #define PLAYER_WIDTH                    24
 
-// Object limits
+// Object limits, overridable for capacity sweeps of the host simulator
+#ifndef MAX_BULLETS
 #define MAX_BULLETS                     20
+#endif
+#ifndef MAX_ENEMIES
 #define MAX_ENEMIES                     16
+#endif
+#ifndef MAX_EXPLOSION
 #define MAX_EXPLOSION                   10
+#endif
+#ifndef MAX_PARTICLES
+#define MAX_PARTICLES                   24
+#endif
 
 // Player settings
 #define PLAYER_INITIAL_X                16
 #define PLAYER_INITIAL_Y_OFFSET         48
-#define PLAYER_INVINCIBILITY_DURATION   150
+#define PLAYER_INVINCIBILITY_DURATION   150    // 2.5 seconds
 #define PLAYER_RESPAWN_DELAY            60
 #define PLAYER_BLINK_RATE               4
 #define PLAYER_BLINK_VISIBLE_FRAMES     2
@@ -67,23 +86,141 @@
 #define FPS_CPU_LOAD_POS_Y              27
 #define FPS_POS_X                       21
 #define FPS_POS_Y                       27
+#define HUD_WIDTH                       40
+#define HUD_ROW_Y                       27
+#define HUD_SCORE_DIGITS                5
+#define HUD_SCORE_OFFSET_X              9
+
+// Frame scheduling
+#define SCHEDULER_POLICY                SCHEDULER_SLOWDOWN
+#define SCHEDULER_MAX_CATCH_UP          2      // Logic steps per frame when catching up
+#define SCHEDULER_LOAD_WINDOW           16     // Frames averaged by the CPU load
+
+// Profiler, markers are compiled out unless built as debug or for the soak harness
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER                 (DEBUG || SOAK_BUILD)
+#endif
+#define PROFILER_RASTER_BARS            1
+#define PROFILER_WINDOW                 16     // Frames averaged per stage
+#define PROFILER_REPORT_FRAMES          256    // Frames between debug log reports
+
+// Event trace, hooks are compiled out unless built as debug
+#define ENABLE_TRACE                    DEBUG
+#define TRACE_CAPACITY                  256    // Records, power of two
+#define TRACE_DUMP_BUTTON               BUTTON_MODE
+#define TRACE_DUMP_ON_DROP              1      // Dump once at the first missed vblank
+
+// Frame statistics kept in SRAM
+#define FRAME_STATS_BUCKETS             32
+#define FRAME_STATS_BUCKET_LINES        16     // Histogram bucket width, last bucket takes the rest
+#define FRAME_STATS_WINDOW_SECONDS      10
+#define FRAME_STATS_WINDOWS             360    // Ring of windows, one hour
+#define FRAME_STATS_FLUSH_WORDS         32     // SRAM words written per frame while a window is stored
+
+// Input recording and replay
+#define INPUT_RECORD_AT_BOOT            0      // Record the session, saved to SRAM when full
+#define INPUT_REPLAY_AT_BOOT            0      // Replay the session saved in SRAM
+#define INPUT_SRAM_OFFSET               0x6000 // After the frame statistics
+#define INPUT_PROBE_TIMEOUT             8      // Presented frames a probe waits for the ship to react
+#ifndef INPUT_MAX_RUNS
+#define INPUT_MAX_RUNS                  256    // Runs of unchanged buttons
+#endif
+#ifndef INPUT_MAX_STEPS
+#define INPUT_MAX_STEPS                 2048   // Logic steps, 34 seconds at 60 Hz
+#endif
+
+// Soak scenarios, selected by the harness through SRAM
+#define SOAK_SRAM_OFFSET                0x7F00 // After the input recording
+#define SOAK_SPAWN_INTERVAL             4      // Steps between spawns of a saturating wave
+#define SOAK_EXPLOSIONS_PER_STEP        2
+
+// Microbenchmarks
+#define MICROBENCH_MAX_SIZE             32     // Largest input size, objects or values per run
+#define MICROBENCH_BATCHES              8      // Timed batches per kernel and size
+#define MICROBENCH_BATCH_LINES          64     // Console batch length, well below a frame
+#define MICROBENCH_BATCH_NS             50000  // Host batch length
+#define MICROBENCH_BUS_FRAMES           10     // Bus contention run, shorter than the shoot sample
+#define MICROBENCH_BUS_COMMANDS         16
+
+// Startup loader
+#define LOADER_MAX_JOBS                 4      // Tile sets and tilemaps streamed at startup
+#define LOADER_MAX_STEPS                8      // Setup steps run between the transfers
+#define LOADER_DMA_BUDGET               16384  // Bytes per vblank, the display is off while loading
+#define LOADER_MAX_ROWS                 16     // Tilemap rows per batch, bounded by the DMA buffer
+#define LOADER_FADE_STEP_FRAMES         2
+
+// Render buffers
+#define RENDER_MAX_PATCHES              8
+#define RENDER_MAX_PATCH_TILES          128
+#define RENDER_TEXT_ATTR                TILE_ATTR(PAL0, TRUE, FALSE, FALSE)
+
+// Palette manager
+#define PAL_MANAGER_LINES               4
+#define PAL_MANAGER_COLORS              64
+#define PAL_MANAGER_FIRST_LINE          PAL1   // PAL0 belongs to the background
+#define PAL_MANAGER_FLASH_COLOR         0x0EEE // Every sprite color on the hit flash line
+#define HIT_FLASH_TICKS                 BLINK_TICKS
+
+// DMA budget, bytes one vblank moves with the display on (SGDK default transfer limits)
+#define DMA_BUDGET_NTSC                 7200
+#define DMA_BUDGET_PAL                  15000
+
+// Session arena
+#if HOST_BUILD
+#define ARENA_SIZE                      65532  // Host pointers are twice the size, room for batchsim limits
+#else
+#define ARENA_SIZE                      24576  // Players, object pools and collision grid
+#endif
+#define ARENA_STACK_CHECK               2048   // Stack bytes checked below the Game_Init frame
+#define ARENA_STACK_MARGIN              64     // Left alone right below the frame
+#define ARENA_STACK_PATTERN             0xA55A
+
+// VRAM manager
+#define VRAM_MAX_SHEETS                 8
+#define VRAM_MAX_SLOTS                  16
+#define VRAM_MAX_UPLOADS                16
+#define VRAM_RESIDENT_MAX_TILES         96     // Larger sheets are streamed
+#define VRAM_STREAM_BUDGET              1024   // Streamed frame bytes per frame
+#define VRAM_SPRITE_ENGINE_TILES        64     // Sprite engine region for unmanaged sprites
+
+// Background tile animations
+#define TILE_ANIM_MAX                   4
+#define TILE_ANIM_BUDGET                512    // Animated tile bytes per frame, after the sprite uploads
+#define TILE_ANIM_STAR_TICKS            10     // Frames per twinkle step at 60 Hz
 
 // Animation and effects
 #define EXPLOSION_X_OFFSET              8
-#define NORMAL_FRAME                    0
-#define DAMAGE_FRAME                    1
 #define PLAYER_NEUTRAL_ANIM             0
 #define PLAYER_UP_ANIM                  1
 #define PLAYER_DOWN_ANIM                2
 
+// Particles
+#define PARTICLE_LOAD_HIGH              85     // CPU load (%) halving the particle cap
+#define PARTICLE_LOAD_CRITICAL          100    // CPU load (%) stopping new particles
+#define EXPLOSION_DEBRIS_COUNT          6
+#define EXPLOSION_DEBRIS_LIFE           16
+#define EXPLOSION_SMOKE_COUNT           2
+#define EXPLOSION_SMOKE_LIFE            24
+#define HIT_SPARK_COUNT                 3
+#define HIT_SPARK_LIFE                  6
+
 // Sound settings
-#define SHOOT_SOUND_CHANNEL             SOUND_PCM_CH2
-#define EXPLOSION_SOUND_CHANNEL         SOUND_PCM_CH3
+#define SFX_FIRST_CHANNEL               SOUND_PCM_CH2  // CH1 is left to the music
+#define SFX_NUM_CHANNELS                2
+#define SFX_PCM_RATE                    13300  // XGM2 PCM sample bytes per second
+#define SFX_RETRIGGER_FRAMES            4      // An effect younger than this is not restarted
+#define MUSIC_WAVES_PER_TRACK           8      // Enemy waves before the next stage track
+#define MUSIC_FADE_FRAMES               30
+#define MUSIC_ROM_WINDOW                0x400000 // ROM bytes mapped without bank switching
 
 // =============================================
 // Macros
 // =============================================
 
+// Convert 60 Hz per-frame values to 50 Hz (compile time only)
+#define PAL_SPEED(value)                ((value) * 6 / 5)
+#define PAL_FRAMES(frames)              ((frames) * 5 / 6)
+
 // Iterate through all allocated objects in a pool
 #define FOREACH_ALLOCATED_IN_POOL(ObjectType, object, pool) \
     u16 object##objectsNum = POOL_getNumAllocated(pool); \
@@ -92,6 +229,20 @@
          object##objectsNum-- != 0; \
          object##FirstPtr++, object = *object##FirstPtr)
 
+// Mutable game state is per thread in threaded host builds, one session per thread
+#if HOST_THREADS
+#define GAME_TLS                        _Thread_local
+#else
+#define GAME_TLS
+#endif
+
+// Work counters of host builds, see host/host_stub.h
+#if HOST_BUILD
+#define HOST_COUNT(counter)             (hostCounters.counter++)
+#else
+#define HOST_COUNT(counter)
+#endif
+
 // Iterate through all active players in the linked list
 #define FOREACH_ACTIVE_PLAYER(player) \
     for (Player *player = game.playerListHead; player != NULL; player = player->next)
@@ -0,0 +1,126 @@
+// Vblank DMA bandwidth shared by everything Render_Present() queues. Requests are made
+// in priority order, each one is granted only while the frame total stays within what
+// one vblank can move, so the flush ends before the active display and never eats into
+// the next frame. Work that does not fit stays with its owner and is asked for again
+// the next frame. The startup loader runs with the display off and keeps its own budget.
+//
+
+#include <genesis.h>
+#include "dma_budget.h"
+#include "defs.h"
+
+static GAME_TLS DmaClassStats stats[DMA_CLASS_COUNT];
+static GAME_TLS u16 capacity = DMA_BUDGET_NTSC;
+static GAME_TLS u16 usedBytes = 0;
+static GAME_TLS u16 peakUsedBytes = 0;
+static GAME_TLS u32 overruns = 0;
+
+static const char *const classNames[DMA_CLASS_COUNT] = {
+    [DMA_CLASS_SPRITES] = "sprites",
+    [DMA_CLASS_SCROLL] = "scroll",
+    [DMA_CLASS_PALETTE] = "palette",
+    [DMA_CLASS_TILES] = "tiles",
+    [DMA_CLASS_HUD] = "hud",
+};
+
+
+// Clear the statistics and pick the vblank capacity of the video system
+void DmaBudget_Init()
+{
+    memset(stats, 0, sizeof(stats));
+    capacity = IS_PAL_SYSTEM ? DMA_BUDGET_PAL : DMA_BUDGET_NTSC;
+    usedBytes = 0;
+    peakUsedBytes = 0;
+    overruns = 0;
+}
+
+// Start counting the transfers of the next vblank
+void DmaBudget_BeginFrame()
+{
+    for (u16 i = 0; i < DMA_CLASS_COUNT; i++)
+        stats[i].frameBytes = 0;
+    usedBytes = 0;
+}
+
+// Count transfers that were queued without asking, they still take bandwidth from the rest
+void DmaBudget_Charge(DmaClass dmaClass, u16 bytes)
+{
+    stats[dmaClass].frameBytes += bytes;
+    stats[dmaClass].totalBytes += bytes;
+    usedBytes += bytes;
+}
+
+// Ask for bandwidth before queueing, on FALSE the caller keeps the work for the next frame
+bool DmaBudget_Request(DmaClass dmaClass, u16 bytes)
+{
+    if (usedBytes + bytes > capacity)
+    {
+        stats[dmaClass].deferredBytes += bytes;
+        return FALSE;
+    }
+
+    DmaBudget_Charge(dmaClass, bytes);
+    return TRUE;
+}
+
+// Bytes the coming vblank can still take
+u16 DmaBudget_GetFree()
+{
+    return (usedBytes < capacity) ? capacity - usedBytes : 0;
+}
+
+// Close the frame, called once everything for the vblank is queued
+void DmaBudget_EndFrame()
+{
+    for (u16 i = 0; i < DMA_CLASS_COUNT; i++)
+    {
+        if (stats[i].frameBytes > stats[i].peakBytes)
+            stats[i].peakBytes = stats[i].frameBytes;
+    }
+
+    // Only charged transfers can go over, the sprite engine alone filled the vblank
+    if (usedBytes > capacity)
+        overruns++;
+
+    if (usedBytes > peakUsedBytes)
+    {
+        peakUsedBytes = usedBytes;
+#if DEBUG
+        DmaBudget_Report();
+#endif
+    }
+}
+
+// Get the statistics of a class
+const DmaClassStats *DmaBudget_GetStats(DmaClass dmaClass)
+{
+    return &stats[dmaClass];
+}
+
+// Bytes one vblank can move
+u16 DmaBudget_GetCapacity()
+{
+    return capacity;
+}
+
+// Frames which queued more than one vblank can move
+u32 DmaBudget_GetOverruns()
+{
+    return overruns;
+}
+
+// Get the printable name of a class
+const char *DmaBudget_GetClassName(DmaClass dmaClass)
+{
+    return classNames[dmaClass];
+}
+
+// Print the bytes of every class to the debug log
+void DmaBudget_Report()
+{
+    kprintf("DMA: %u of %u bytes last frame, %u peak, %lu overruns", usedBytes, capacity, peakUsedBytes, overruns);
+
+    for (u16 i = 0; i < DMA_CLASS_COUNT; i++)
+        kprintf("  %s: %u bytes last frame, %u peak, %lu deferred", classNames[i], stats[i].frameBytes,
+                stats[i].peakBytes, stats[i].deferredBytes);
+}
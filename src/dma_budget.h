@@ -0,0 +1,49 @@
+#ifndef HEADER_DMA_BUDGET
+#define HEADER_DMA_BUDGET
+
+#include <genesis.h>
+
+// Kinds of vblank transfers, in the order they get the bandwidth
+typedef enum
+{
+    DMA_CLASS_SPRITES,      // Sprite table and sprite engine tiles, never deferred
+    DMA_CLASS_SCROLL,       // Horizontal scroll rows
+    DMA_CLASS_PALETTE,      // CRAM colors
+    DMA_CLASS_TILES,        // Streamed sprite frames and animated background tiles
+    DMA_CLASS_HUD,          // Tilemap patches
+    DMA_CLASS_COUNT
+} DmaClass;
+
+// Transfer statistics of one class
+typedef struct
+{
+    u16 frameBytes;         // Bytes queued for the coming vblank
+    u16 peakBytes;          // Largest frameBytes so far
+    u32 totalBytes;         // Bytes queued since init
+    u32 deferredBytes;      // Bytes pushed to a later frame since init
+} DmaClassStats;
+
+
+void DmaBudget_Init();
+
+void DmaBudget_BeginFrame();
+
+void DmaBudget_Charge(DmaClass dmaClass, u16 bytes);
+
+bool DmaBudget_Request(DmaClass dmaClass, u16 bytes);
+
+u16 DmaBudget_GetFree();
+
+void DmaBudget_EndFrame();
+
+const DmaClassStats *DmaBudget_GetStats(DmaClass dmaClass);
+
+u16 DmaBudget_GetCapacity();
+
+u32 DmaBudget_GetOverruns();
+
+const char *DmaBudget_GetClassName(DmaClass dmaClass);
+
+void DmaBudget_Report();
+
+#endif //HEADER_DMA_BUDGET
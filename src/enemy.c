@@ -7,18 +7,27 @@
 #include "player.h"
 #include "resources.h"
 #include "defs.h"
+#include "pal_manager.h"
+#include "motion.h"
+#include "trace.h"
+#include "music.h"
 #include <maths.h>
 #include <genesis.h>
 
 
+static GAME_TLS u16 enemyPalette = PAL0;
+
 // Spawns enemy at specified position
 void Enemy_Spawn(fix16 x, fix16 y)
 {
     // Allocate and initialize enemy
     GameObject *enemy = (GameObject *) POOL_allocate(game.enemyPool);
     if (enemy)
-        GameObject_Init(enemy, &enemy_sprite, PAL3, x, y,
+    {
+        GameObject_Init(enemy, &enemy_sprite, enemyPalette, x, y,
                         ENEMY_WIDTH, ENEMY_HEIGHT, ENEMY_HP, ENEMY_DAMAGE);
+        TRACE(TRACE_SPAWN_ENEMY, F16_toInt(x), F16_toInt(y));
+    }
 }
 
 // Set current enemy spawner configuration
@@ -26,8 +35,9 @@ void EnemySpawner_Set(EnemySpawner *spawner)
 {
     game.wave.spawner = spawner;
     game.wave.active = FALSE;
-    game.wave.delay = spawner->delay;
-    game.wave.enemyDelay = spawner->enemyDelay;
+    game.wave.delay = Motion_Frames(spawner->delay);
+    game.wave.enemyInterval = Motion_Frames(spawner->enemyDelay);
+    game.wave.enemyDelay = game.wave.enemyInterval;
     game.wave.spawnedCount = 0;
 }
 
@@ -48,7 +58,7 @@ void EnemySpawner_Update()
     game.wave.enemyDelay--;
     
     if (!game.wave.enemyDelay)
-        game.wave.enemyDelay = game.wave.spawner->enemyDelay;
+        game.wave.enemyDelay = game.wave.enemyInterval;
     else
         return;
     
@@ -88,12 +98,15 @@ void EnemyWave_Switch()
         EnemySpawner_Set((EnemySpawner *) &game.lineSpawner);
     else
         EnemySpawner_Set((EnemySpawner *) &game.sinSpawner);
+
+    TRACE(TRACE_WAVE_SWITCH, game.wave.spawner->pattern, game.wave.spawner->enemyCount);
+    Music_OnWaveSwitch();
 }
 
 // Initialize enemies palette and resources
 void Enemies_Init()
 {
-    PAL_setPalette(PAL3, enemy_sprite.palette->data, DMA);
+    enemyPalette = PalManager_Acquire(enemy_sprite.palette);
 }
 
 // Updates all active enemies
@@ -104,16 +117,11 @@ void Enemies_Update()
         if (!enemy)
             continue;
         
-        // Handle damage blink effect
-        if (enemy->blinkCounter)
-        {
-            enemy->blinkCounter--;
-            if (enemy->blinkCounter == 0)
-                SPR_setFrame(enemy->sprite, 0);  // Reset to normal frame
-        }
+        // Handle damage flash effect
+        GameObject_UpdateFlash((GameObject *) enemy);
         
         // Move enemy left
-        enemy->x -= ENEMY_SPEED;
+        enemy->x -= motion->enemySpeed;
         SPR_setPosition(enemy->sprite, F16_toInt(enemy->x), F16_toInt(enemy->y));
         
         // Remove enemy if it goes off-screen
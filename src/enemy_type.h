@@ -34,6 +34,7 @@ typedef struct {
     EnemySpawner *spawner;  // Pointer to spawner configuration
     u16 delay;              // Current delay counter
     u16 enemyDelay;         // Current enemy delay counter
+    u16 enemyInterval;      // Frames between enemy spawns for the running region
     u16 spawnedCount;       // Number of enemies spawned so far
     bool active;            // Whether wave is currently active
 } EnemyWave;
@@ -8,6 +8,21 @@
 #include "globals.h"
 #include "game_object.h"
 #include "resources.h"
+#include "pal_manager.h"
+#include "particles.h"
+#include "motion.h"
+#include "trace.h"
+#include "sfx.h"
+
+static GAME_TLS u16 explosionPalette = PAL0;
+
+
+// Load explosion palette, the explosion and particle sheets use the upper colors of the enemy palette
+void Explosions_Init()
+{
+    explosionPalette = PalManager_Acquire(enemy_sprite.palette);
+    Particles_Init(explosionPalette);
+}
 
 // Spawns explosion effect at specified position
 void Explosion_Spawn(fix16 x, fix16 y)
@@ -18,12 +33,19 @@ void Explosion_Spawn(fix16 x, fix16 y)
     if (explosion)
     {
         // Initialize explosion (no HP or damage as it's just visual)
-        GameObject_Init(explosion, &explosion_sprite, PAL2, x - OBJECT_SIZE/2, y,
+        GameObject_Init(explosion, &explosion_sprite, explosionPalette, x - FIX16(OBJECT_SIZE / 2), y,
                         OBJECT_SIZE, OBJECT_SIZE, 0, 0);
         SPR_setAlwaysOnTop(explosion->sprite);
         SPR_setAnimationLoop(explosion->sprite, FALSE);  // Play once
-        XGM2_playPCM(xpcm_explosion, sizeof(xpcm_explosion), SOUND_PCM_CH3);
+        Sfx_Play(SFX_EXPLOSION);
+        TRACE(TRACE_SPAWN_EXPLOSION, F16_toInt(x), F16_toInt(y));
     }
+    
+    // Debris and smoke are cheap enough to show even when the explosion pool is full
+    Particles_Burst(PARTICLE_DEBRIS, x + FIX16(OBJECT_SIZE / 2), y + FIX16(OBJECT_SIZE / 2),
+                    EXPLOSION_DEBRIS_COUNT, EXPLOSION_DEBRIS_LIFE);
+    Particles_Burst(PARTICLE_SMOKE, x + FIX16(OBJECT_SIZE / 2), y + FIX16(OBJECT_SIZE / 2),
+                    EXPLOSION_SMOKE_COUNT, EXPLOSION_SMOKE_LIFE);
 }
 
 // Update all active explosions animation state
@@ -38,7 +60,7 @@ void Explosions_Update()
         
         // Update position and check animation completion
         SPR_setPosition(explosion->sprite, F16_toInt(explosion->x), F16_toInt(explosion->y));
-        explosion->x += ENEMY_SPEED;
+        explosion->x += motion->enemySpeed;
         
         // Return object back to pool if animation finished
         if (SPR_isAnimationDone(explosion->sprite))
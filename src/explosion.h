@@ -7,6 +7,8 @@
 
 #include <types.h>
 
+void Explosions_Init();
+
 void Explosion_Spawn(s16 x, s16 y);
 
 void Explosions_Update();
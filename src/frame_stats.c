@@ -0,0 +1,212 @@
+// Frame cost statistics for long sessions. Every frame adds its cost in scanlines to
+// a histogram, each FRAME_STATS_WINDOW_SECONDS window is stored in an SRAM ring
+// together with the session totals and a snapshot of the worst frame. The record is
+// restarted at boot, read the SRAM before power cycling a soak run.
+// A finished window is written out over the following frames, at most
+// FRAME_STATS_FLUSH_WORDS words per frame, after the cost of the frame was taken.
+//
+// SRAM layout (byte offsets):
+//   0   magic 'FSTA', version, bucket width in lines, windows in the ring
+//   12  lines per frame, frames per second
+//   16  windows written, frames counted
+//   24  worst frame snapshot
+//   64  session histogram, u32 per bucket
+//   192 window ring, u16 per bucket
+//
+
+#include <genesis.h>
+#include "frame_stats.h"
+#include "defs.h"
+#include "globals.h"
+#include "motion.h"
+#include "particles.h"
+#include "profiler.h"
+#include "scheduler.h"
+
+#define FRAME_STATS_MAGIC           0x46535441  // 'FSTA'
+#define FRAME_STATS_VERSION         2
+
+#define SRAM_LINES_PER_FRAME        12
+#define SRAM_FRAMES_PER_SECOND      14
+#define SRAM_WINDOWS_WRITTEN        16
+#define SRAM_FRAMES_COUNTED         20
+#define SRAM_WORST                  24
+#define SRAM_TOTALS                 64
+#define SRAM_WINDOWS                (SRAM_TOTALS + FRAME_STATS_BUCKETS * 4)
+
+// Words of a pending flush going to one SRAM offset
+typedef struct
+{
+    u32 offset;
+    const u16 *words;
+    u16 count;
+} FrameStatsBlock;
+
+static GAME_TLS u16 window[FRAME_STATS_BUCKETS];
+static GAME_TLS u32 totals[FRAME_STATS_BUCKETS];
+static GAME_TLS u16 windowFrames = 0;
+static GAME_TLS u32 windowsWritten = 0;
+static GAME_TLS u32 framesCounted = 0;
+
+static GAME_TLS u16 frameStart = 0;
+static GAME_TLS FrameSnapshot worst;
+static GAME_TLS bool worstChanged = FALSE;
+
+// Copies of a finished window, written out over the next frames
+static GAME_TLS u16 flushWindow[FRAME_STATS_BUCKETS];
+static GAME_TLS u32 flushTotals[FRAME_STATS_BUCKETS];
+static GAME_TLS FrameSnapshot flushWorst;
+static GAME_TLS u32 flushFrames = 0;
+static GAME_TLS FrameStatsBlock flushBlocks[3];
+static GAME_TLS u16 numFlushBlocks = 0;
+static GAME_TLS u16 flushBlock = 0;
+static GAME_TLS u16 flushWord = 0;
+
+
+// Write a block of words to SRAM, SRAM must be enabled
+static void FrameStats_WriteWords(u32 offset, const u16 *words, u16 count)
+{
+    for (u16 i = 0; i < count; i++)
+        SRAM_writeWord(offset + i * 2, words[i]);
+}
+
+// Copy the finished window, the totals and the worst frame for the flush
+static void FrameStats_StartFlush()
+{
+    u32 slot = windowsWritten % FRAME_STATS_WINDOWS;
+
+    memcpyU16(flushWindow, window, FRAME_STATS_BUCKETS);
+    memcpyU16((u16 *) flushTotals, (const u16 *) totals, FRAME_STATS_BUCKETS * 2);
+    flushFrames = framesCounted;
+
+    flushBlocks[0] = (FrameStatsBlock) {SRAM_WINDOWS + slot * FRAME_STATS_BUCKETS * 2, flushWindow,
+                                        FRAME_STATS_BUCKETS};
+    flushBlocks[1] = (FrameStatsBlock) {SRAM_TOTALS, (const u16 *) flushTotals, FRAME_STATS_BUCKETS * 2};
+    numFlushBlocks = 2;
+
+    if (worstChanged)
+    {
+        flushWorst = worst;
+        flushBlocks[numFlushBlocks++] = (FrameStatsBlock) {SRAM_WORST, (const u16 *) &flushWorst,
+                                                           sizeof(FrameSnapshot) / 2};
+        worstChanged = FALSE;
+    }
+
+    flushBlock = 0;
+    flushWord = 0;
+}
+
+// Write the next part of a pending flush
+static void FrameStats_FlushStep()
+{
+    u16 budget = FRAME_STATS_FLUSH_WORDS;
+
+    SRAM_enable();
+    while (budget && flushBlock < numFlushBlocks)
+    {
+        const FrameStatsBlock *block = &flushBlocks[flushBlock];
+        u16 count = min(block->count - flushWord, budget);
+
+        FrameStats_WriteWords(block->offset + flushWord * 2, block->words + flushWord, count);
+        flushWord += count;
+        budget -= count;
+
+        if (flushWord == block->count)
+        {
+            flushBlock++;
+            flushWord = 0;
+        }
+    }
+
+    // Counters last, a reader never sees a window that is only half written
+    if (flushBlock == numFlushBlocks)
+    {
+        windowsWritten++;
+        SRAM_writeLong(SRAM_WINDOWS_WRITTEN, windowsWritten);
+        SRAM_writeLong(SRAM_FRAMES_COUNTED, flushFrames);
+        numFlushBlocks = 0;
+    }
+    SRAM_disable();
+}
+
+// Take a snapshot of the frame that just became the most expensive one
+static void FrameStats_CaptureWorst(u16 lines)
+{
+    worst.frame = Scheduler_GetFrame();
+    worst.lines = lines;
+    worst.enemies = POOL_getNumAllocated(game.enemyPool);
+    worst.projectiles = POOL_getNumAllocated(game.projectilePool);
+    worst.explosions = POOL_getNumAllocated(game.explosionPool);
+    worst.particles = Particles_GetCount();
+    worst.wavePattern = game.wave.spawner->pattern;
+    worst.waveSpawned = game.wave.spawnedCount;
+    worst.dmaBytes = DMA_getQueueTransferSize();
+
+    for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+        worst.stageLines[i] = ENABLE_PROFILER ? Profiler_GetStats(i)->current : 0;
+
+    worstChanged = TRUE;
+}
+
+// Start a new record in SRAM
+void FrameStats_Init()
+{
+    memsetU16(window, 0, FRAME_STATS_BUCKETS);
+    memset(totals, 0, sizeof(totals));
+    memset(&worst, 0, sizeof(worst));
+    windowFrames = 0;
+    numFlushBlocks = 0;
+    windowsWritten = 0;
+    framesCounted = 0;
+    worstChanged = FALSE;
+
+    SRAM_enable();
+    SRAM_writeLong(0, FRAME_STATS_MAGIC);
+    SRAM_writeWord(4, FRAME_STATS_VERSION);
+    SRAM_writeWord(6, FRAME_STATS_BUCKET_LINES);
+    SRAM_writeWord(8, FRAME_STATS_BUCKETS);
+    SRAM_writeWord(10, FRAME_STATS_WINDOWS);
+    SRAM_writeWord(SRAM_LINES_PER_FRAME, motion->linesPerFrame);
+    SRAM_writeWord(SRAM_FRAMES_PER_SECOND, motion->framesPerSecond);
+    SRAM_writeLong(SRAM_WINDOWS_WRITTEN, 0);
+    SRAM_writeLong(SRAM_FRAMES_COUNTED, 0);
+    FrameStats_WriteWords(SRAM_WORST, (const u16 *) &worst, sizeof(FrameSnapshot) / 2);
+    SRAM_disable();
+}
+
+// Mark the start of the frame work, right after the scheduler released the frame
+void FrameStats_BeginFrame()
+{
+    frameStart = Profiler_GetLineClock();
+}
+
+// Count the frame, called once the frame was handed to the vblank handler
+void FrameStats_EndFrame()
+{
+    u16 lines = Profiler_GetLineClock() - frameStart;
+    u16 bucket = min(lines / FRAME_STATS_BUCKET_LINES, FRAME_STATS_BUCKETS - 1);
+
+    window[bucket]++;
+    totals[bucket]++;
+    framesCounted++;
+
+    if (lines > worst.lines)
+        FrameStats_CaptureWorst(lines);
+
+    // The cost of this frame is taken, SRAM writes of the flush do not show in the statistics
+    if (numFlushBlocks)
+        FrameStats_FlushStep();
+
+    if (++windowFrames == FRAME_STATS_WINDOW_SECONDS * motion->framesPerSecond)
+    {
+        FrameStats_StartFlush();
+        memsetU16(window, 0, FRAME_STATS_BUCKETS);
+        windowFrames = 0;
+    }
+}
+
+// Most expensive frame of the session
+const FrameSnapshot *FrameStats_GetWorst()
+{
+    return &worst;
+}
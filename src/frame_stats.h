@@ -0,0 +1,32 @@
+#ifndef HEADER_FRAME_STATS
+#define HEADER_FRAME_STATS
+
+#include <genesis.h>
+#include "defs.h"
+#include "profiler.h"
+
+// State of the game during the most expensive frame
+typedef struct
+{
+    u32 frame;                              // Scheduler frame number
+    u16 lines;                              // Frame cost in scanlines
+    u16 enemies;                            // Allocated objects per pool
+    u16 projectiles;
+    u16 explosions;
+    u16 particles;
+    u16 wavePattern;
+    u16 waveSpawned;
+    u16 dmaBytes;                           // Bytes queued for the following vblank
+    u16 stageLines[PROF_STAGE_COUNT];       // Profiler stages, zero when the profiler is compiled out
+} FrameSnapshot;
+
+
+void FrameStats_Init();
+
+void FrameStats_BeginFrame();
+
+void FrameStats_EndFrame();
+
+const FrameSnapshot *FrameStats_GetWorst();
+
+#endif //HEADER_FRAME_STATS
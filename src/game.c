@@ -22,87 +22,285 @@
 #include "game_types.h"
 #include "enemy_type.h"
 #include "explosion.h"
+#include "render.h"
+#include "hud.h"
+#include "pal_manager.h"
+#include "vram_manager.h"
+#include "particles.h"
+#include "scheduler.h"
+#include "motion.h"
+#include "profiler.h"
+#include "trace.h"
+#include "frame_stats.h"
+#include "input.h"
+#include "soak.h"
+#include "loader.h"
+#include "background.h"
+#include "tile_anim.h"
+#include "sfx.h"
+#include "music.h"
+#include "arena.h"
+
+// Both planes use the shared tile set built by tools/tile_optimizer.py
+static const TileMap mapTilemap = {COMPRESSION_NONE, BACKGROUND_MAP_WIDTH, BACKGROUND_MAP_HEIGHT,
+                                   (u16 *) mapTilemapData};
+static const TileMap backTilemap = {COMPRESSION_NONE, BACKGROUND_BACK_WIDTH, BACKGROUND_BACK_HEIGHT,
+                                    (u16 *) backTilemapData};
 
 // =============================================
 // Function Implementations
 // =============================================
 
+// Loading step: lay out the sprite sheets right after the background tiles
+static void Game_InitSprites()
+{
+    VramManager_Init(TILE_USER_INDEX + bgTileset.numTile);
+    VramManager_Register(&player_sprite, "player", VRAM_POLICY_AUTO, 2);
+    VramManager_Register(&enemy_sprite, "enemy", VRAM_POLICY_AUTO, MAX_ENEMIES);
+    VramManager_Register(&bullet_sprite, "bullet", VRAM_POLICY_AUTO, MAX_BULLETS);
+    VramManager_Register(&explosion_sprite, "explosion", VRAM_POLICY_AUTO, MAX_EXPLOSION);
+    VramManager_Register(&particle_sprite, "particle", VRAM_POLICY_RESIDENT, MAX_PARTICLES);
+#if DEBUG
+    VramManager_Report();
+#endif
+}
+
+// Loading step: create the players, the first one joined
+static void Game_InitPlayers()
+{
+    Players_Create();
+    Player_Add(0);
+    Game_RenderScore(&game.players[0]);
+}
+
+// Loading step: effects, enemies, statistics and the input session
+static void Game_InitWorld()
+{
+    PalManager_AcquireFlash();
+    Explosions_Init();
+    Enemies_Init();
+    EnemySpawner_Set((EnemySpawner *) &game.sinSpawner);
+    TileAnim_Add(&anim_star, TILE_USER_INDEX + BACKGROUND_STAR_TILE, BACKGROUND_STAR_TILES, Motion_Frames(TILE_ANIM_STAR_TICKS));
+    FrameStats_Init();
+
+    Input_Init();
+#if INPUT_REPLAY_AT_BOOT
+    if (Input_LoadRecording())
+        Input_StartReplay();
+#elif INPUT_RECORD_AT_BOOT
+    Input_StartRecording();
+#endif
+#if SOAK_BUILD
+    Soak_Init();
+#endif
+}
+
 // Initialize all game systems and resources
 void Game_Init()
 {
+    // A new session, the memory of the last one is free again and nothing may point into it,
+    // the grid is always taken anew by Grid_Init
+    Arena_Reset();
+    game.players = NULL;
+    game.playerListHead = NULL;
+    game.enemyPool = NULL;
+    game.projectilePool = NULL;
+    game.explosionPool = NULL;
+    Motion_Init();
+    Profiler_Init();
+    Trace_Init();
+    Sfx_Init();
     VDP_setScrollingMode(HSCROLL_TILE, VSCROLL_PLANE);
-    Z80_loadDriver(Z80_DRIVER_XGM2, TRUE);
 
-#if PLAY_MUSIC
-    XGM2_play(xgm2_music);
+    // The soak harness runs without a Z80
+#if !SOAK_BUILD
+    Z80_loadDriver(Z80_DRIVER_XGM2, TRUE);
 #endif
+    Music_Init();
 
     JOY_init();
-    SPR_init();
+    SPR_initEx(VRAM_SPRITE_ENGINE_TILES);
+    Render_Init();
+    Hud_Init();
+    PalManager_Init();
+
+    // Backgrounds stream in over the first vblanks, the rest of the setup runs meanwhile
+    Loader_Start();
+    Loader_QueueTileSet(&bgTileset, TILE_USER_INDEX);
+    Loader_QueueTileMap(BG_A, &mapTilemap, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USER_INDEX));
+    Loader_QueueTileMap(BG_B, &backTilemap, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USER_INDEX));
+    PalManager_Load(PAL0, &bgPalette);
+
+    TileAnim_Init();
+
+    Loader_AddStep(Game_InitSprites);
+    Loader_AddStep(Game_ObjectsPoolsInit);
+    Loader_AddStep(Game_InitPlayers);
+    Loader_AddStep(Game_InitWorld);
+
+    Scheduler_Init(SCHEDULER_POLICY);
+}
 
-    VDP_drawImageEx(BG_A, &mapImage, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USER_INDEX),
-                    0, 0, TRUE, TRUE);
-    VDP_drawImageEx(BG_B, &bgImage, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE,
-                                                   TILE_USER_INDEX + mapImage.tileset->numTile), 0, 0, TRUE, TRUE);
+// Run one fixed logic step
+void Game_Update()
+{
+    PROFILE_BEGIN(PROF_INPUT);
+    Input_BeginStep();
+    Game_PlayerJoinUpdate();
+    PROFILE_END(PROF_INPUT);
 
-    PAL_setPalette(PAL1, player_sprite.palette->data, DMA);
-    Game_ObjectsPoolsInit();
-    Players_Create();
-    Player_Add(0);
-    Game_RenderScore(&game.players[0]);
-    PAL_setPalette(PAL2, explosion_sprite.palette->data, DMA);
-    Enemies_Init();
-    EnemySpawner_Set(&game.sinSpawner);
+    FOREACH_ACTIVE_PLAYER(player)
+    {
+        PROFILE_BEGIN(PROF_INPUT);
+        Player_UpdateInput(player);
+        PROFILE_END(PROF_INPUT);
+
+        PROFILE_BEGIN(PROF_PLAYER);
+        Player_Update(player);
+        PROFILE_END(PROF_PLAYER);
+
+        PROFILE_BEGIN(PROF_COLLISION);
+        Player_UpdateEnemyCollision(player);
+        PROFILE_END(PROF_COLLISION);
+    }
+
+    PROFILE_BEGIN(PROF_PROJECTILE);
+    Projectile_Update();
+    PROFILE_END(PROF_PROJECTILE);
+
+    PROFILE_BEGIN(PROF_ENEMIES);
+    Enemies_Update();
+    PROFILE_END(PROF_ENEMIES);
+
+    PROFILE_BEGIN(PROF_EXPLOSIONS);
+    Explosions_Update();
+    Particles_Update();
+    PROFILE_END(PROF_EXPLOSIONS);
+
+    PROFILE_BEGIN(PROF_COLLISION);
+    Projectile_UpdateEnemyCollision();
+    PROFILE_END(PROF_COLLISION);
+
+    PROFILE_BEGIN(PROF_SPAWNER);
+    EnemySpawner_Update();
+#if SOAK_BUILD
+    Soak_Update();
+#endif
+    PROFILE_END(PROF_SPAWNER);
+
+    Input_EndStep(Game_HashState());
 }
 
-// Add frame timing variables
-static u32 lastFrameTime = 0;
-static fix16 deltaTime = 0;
+// Hash the gameplay state of all pools and players, pointers and visual-only state left out
+static u32 Game_HashPool(u32 hash, Pool *pool)
+{
+    FOREACH_ALLOCATED_IN_POOL(GameObject, object, pool)
+    {
+        hash = INPUT_HASH_MIX(hash, ((u32) object->x << 16) | (u16) object->y);
+        hash = INPUT_HASH_MIX(hash, object->hp);
+    }
 
-// Optimized main game loop with frame timing
-void Game_MainLoop()
+    return INPUT_HASH_MIX(hash, POOL_getNumAllocated(pool));
+}
+
+// Hash of the state a logic step leaves, compared between recording and replay
+u32 Game_HashState()
 {
-    while (TRUE)
+    u32 hash = 0;
+
+    FOREACH_PLAYER(player)
     {
-        u32 currentTime = SYS_getTime();
-        deltaTime = FIX16(currentTime - lastFrameTime) / FIX16(60); // 60 FPS target
-        lastFrameTime = currentTime;
+        hash = INPUT_HASH_MIX(hash, ((u32) player->x << 16) | (u16) player->y);
+        hash = INPUT_HASH_MIX(hash, ((u32) player->state << 16) | ((u32) player->lives << 8) | (u16) player->hp);
+        hash = INPUT_HASH_MIX(hash, player->score);
+        hash = INPUT_HASH_MIX(hash, ((u32) player->coolDownTicks << 16) | player->invincibleTimer);
+        hash = INPUT_HASH_MIX(hash, player->respawnTimer);
+    }
 
-        // Cap delta time to prevent large jumps
-        if (deltaTime > FIX16(2)) deltaTime = FIX16(2);
+    hash = INPUT_HASH_MIX(hash, ((u32) game.wave.spawner->pattern << 16) | game.wave.spawnedCount);
+    hash = INPUT_HASH_MIX(hash, ((u32) game.wave.delay << 16) | game.wave.enemyDelay);
 
-        Game_PlayerJoinUpdate();
+    hash = Game_HashPool(hash, game.enemyPool);
+    hash = Game_HashPool(hash, game.projectilePool);
+    return Game_HashPool(hash, game.explosionPool);
+}
 
-        FOREACH_ACTIVE_PLAYER(player)
-        {
-            Player_UpdateInput(player);
-            Player_Update(player);
-            Player_UpdateEnemyCollision(player);
-        }
+// Run one displayed frame: wait for the vblank, run the logic steps and render
+void Game_Frame()
+{
+    // Blocks until the next vblank, returns more than one step only when catching up
+    u16 steps = Scheduler_BeginFrame();
 
-        Projectile_Update();
-        Enemies_Update();
-        Explosions_Update();
-        Projectile_UpdateEnemyCollision();
-        EnemySpawner_Update();
+    // Startup frames only stream the backgrounds and run the setup steps
+    if (Loader_IsLoading())
+    {
+        Loader_Update();
+        Hud_Flush();
+        PalManager_Update();
+        Render_Present();
+        return;
+    }
 
-        Game_Render();
-        
-        // Frame rate limiting
-        while (SYS_getTime() - currentTime < 16) // ~60 FPS
+    FrameStats_BeginFrame();
+#if ENABLE_TRACE
+    Game_TraceUpdate(steps);
+#endif
+
+    while (steps--)
+        Game_Update();
+
+    // Hands the frame to the vblank handler
+    PROFILE_BEGIN(PROF_RENDER);
+    Game_Render();
+    PROFILE_END(PROF_RENDER);
+
+    FrameStats_EndFrame();
+    PROFILE_FRAME_END();
+}
+
+// Main game loop, one logic step per vblank
+void Game_MainLoop()
+{
+    while (TRUE)
+        Game_Frame();
+}
+
+#if ENABLE_TRACE
+// Record frame drops and dump the trace on request or at the first drop
+void Game_TraceUpdate(u16 steps)
+{
+    static GAME_TLS u32 lastMissed = 0;
+    static GAME_TLS bool dumped = FALSE;
+    static GAME_TLS u16 lastButtons = 0;
+    u32 missed = Scheduler_GetMissedVBlanks();
+    u16 buttons = Input_GetSnapshot()->buttons[0];
+
+    if (missed != lastMissed)
+    {
+        TRACE(TRACE_FRAME_DROP, missed, steps);
+        lastMissed = missed;
+
+        if (TRACE_DUMP_ON_DROP && !dumped)
         {
-            SYS_doVBlankProcess();
+            Trace_Dump();
+            dumped = TRUE;
         }
     }
+
+    if (buttons & ~lastButtons & TRACE_DUMP_BUTTON)
+        Trace_Dump();
+    lastButtons = buttons;
 }
+#endif
 
 // Optimized object pool initialization
 void Game_ObjectsPoolsInit()
 {
     // Pre-allocate memory for pools
-    game.enemyPool = POOL_create(MAX_ENEMIES, sizeof(Enemy));
-    game.projectilePool = POOL_create(MAX_BULLETS, sizeof(Projectile));
-    game.explosionPool = POOL_create(MAX_EXPLOSION, sizeof(GameObject));
+    game.enemyPool = Arena_CreatePool(ARENA_ENEMIES, MAX_ENEMIES, sizeof(Enemy));
+    game.projectilePool = Arena_CreatePool(ARENA_PROJECTILES, MAX_BULLETS, sizeof(Projectile));
+    game.explosionPool = Arena_CreatePool(ARENA_EXPLOSIONS, MAX_EXPLOSION, sizeof(GameObject));
+    Grid_Init();
 
     // Pre-allocate objects for better performance
     for (u16 i = 0; i < MAX_ENEMIES; i++) {
@@ -130,23 +328,11 @@ void Game_ObjectsPoolsInit()
     }
 }
 
-// Optimized object release
-void GameObject_Release(GameObject *gameObject, Pool *pool)
-{
-    if (!gameObject) return;
-    
-    // Clear object memory for reuse
-    memset(gameObject, 0, sizeof(GameObject));
-    
-    SPR_setVisibility(gameObject->sprite, HIDDEN);
-    POOL_release(pool, gameObject, TRUE);
-}
-
 // Release object with explosion effect
 void GameObject_ReleaseWithExplode(GameObject *object, Pool *pool)
 {
     Explosion_Spawn(object->x - FIX16(EXPLOSION_X_OFFSET), object->y);
-    SPR_setFrame(object->sprite, NORMAL_FRAME);
+    SPR_setPalette(object->sprite, object->palette);
     GameObject_Release(object, pool);
 }
 
@@ -159,10 +345,8 @@ void BackgroundScroll()
         if (scrollRule->autoScrollSpeed == 0) continue;
 
         scrollRule->scrollOffset += scrollRule->autoScrollSpeed;
-        memsetU16((u16 *) game.lineOffsetX[ind], -FF32_toInt(scrollRule->scrollOffset), scrollRule->numOfLines);
-
-        VDP_setHorizontalScrollTile(scrollRule->plane, scrollRule->startLineIndex, game.lineOffsetX[ind],
-                                    scrollRule->numOfLines, DMA_QUEUE);
+        s16 *lineOffsetX = Render_GetHScroll(scrollRule->plane) + scrollRule->startLineIndex;
+        memsetU16((u16 *) lineOffsetX, -FF32_toInt(scrollRule->scrollOffset), scrollRule->numOfLines);
     }
 }
 
@@ -177,11 +361,17 @@ typedef struct {
     u16 count;
 } GridCell;
 
-// Grid system
-static GridCell grid[GRID_WIDTH][GRID_HEIGHT];
+// Grid system, columns of cells in the session arena
+static GAME_TLS GridCell (*grid)[GRID_HEIGHT] = NULL;
+
+// Take the grid from the session arena
+void Grid_Init()
+{
+    grid = Arena_Alloc(ARENA_GRID, sizeof(GridCell) * GRID_WIDTH * GRID_HEIGHT);
+}
 
 // Clear grid
-static void Grid_Clear()
+void Grid_Clear()
 {
     for (u16 x = 0; x < GRID_WIDTH; x++) {
         for (u16 y = 0; y < GRID_HEIGHT; y++) {
@@ -191,7 +381,7 @@ static void Grid_Clear()
 }
 
 // Add object to grid
-static void Grid_AddObject(GameObject *obj)
+void Grid_AddObject(GameObject *obj)
 {
     u16 gridX = F16_toInt(obj->x) / GRID_CELL_SIZE;
     u16 gridY = F16_toInt(obj->y) / GRID_CELL_SIZE;
@@ -234,13 +424,15 @@ void Projectile_UpdateEnemyCollision()
                     
                     for (u16 i = 0; i < cell->count; i++) {
                         Enemy *enemy = (Enemy *)cell->objects[i];
-                        if (GameObject_CollisionUpdate(projectile, (GameObject *)enemy)) {
+                        if (GameObject_CollisionUpdate((GameObject *) projectile, (GameObject *)enemy)) {
                             if (!enemy->hp) {
                                 GameObject_ReleaseWithExplode((GameObject *)enemy, game.enemyPool);
-                                game.players[projectile->ownerIndex].score += ENEMY_SCORE_VALUE;
-                                Player_ScoreUpdate(&game.players[projectile->ownerIndex]);
+                                Player_AddScore(&game.players[projectile->ownerIndex], ENEMY_SCORE_VALUE);
                             }
-                            GameObject_Release(projectile, game.projectilePool);
+                            else
+                                Particles_Burst(PARTICLE_SPARK, projectile->x + FIX16(projectile->w), projectile->y,
+                                                HIT_SPARK_COUNT, HIT_SPARK_LIFE);
+                            GameObject_Release((GameObject *) projectile, game.projectilePool);
                             goto next_projectile;
                         }
                     }
@@ -258,7 +450,7 @@ void Projectile_Update()
     {
         if (projectile)
         {
-            projectile->x += BULLET_OFFSET_X;
+            projectile->x += motion->bulletSpeed;
             SPR_setPosition(projectile->sprite, F16_toInt(projectile->x), F16_toInt(projectile->y));
 
             if (projectile->x > FIX16(SCREEN_WIDTH))
@@ -270,53 +462,51 @@ void Projectile_Update()
 // Render FPS and CPU load
 void RenderFPS()
 {
-    VDP_setTextPalette(PAL0);
-    VDP_setWindowOnBottom(1);
-    VDP_setTextPlane(WINDOW);
-    VDP_showCPULoad(FPS_CPU_LOAD_POS_X, FPS_CPU_LOAD_POS_Y);
-    VDP_showFPS(FALSE, FPS_POS_X, FPS_POS_Y);
+#if SHOW_FPS
+    Hud_DrawStats(Scheduler_GetFps(), Scheduler_GetLoad());
+#endif
 }
 
 // Render player score
 void Game_RenderScore(Player *player)
 {
     if (player->index == 0)
-        VDP_drawTextBG(WINDOW, "1P SCORE:00000", PLAYER1_JOIN_TEXT_POS_X, JOIN_TEXT_POS_Y);
+        Hud_DrawText("1P SCORE:00000", PLAYER1_JOIN_TEXT_POS_X);
     else
-        VDP_drawTextBG(WINDOW, "2P SCORE:00000", PLAYER2_JOIN_TEXT_POS_X, JOIN_TEXT_POS_Y);
+        Hud_DrawText("2P SCORE:00000", PLAYER2_JOIN_TEXT_POS_X);
 }
 
 // Render UI messages like join prompts
 void Game_RenderMessage()
 {
-    static u16 blinkCounter;
+    static GAME_TLS u16 blinkCounter;
     blinkCounter++;
 
     FOREACH_PLAYER(player)
     {
-        switch (blinkCounter)
+        if (blinkCounter == 1)
         {
-            case 1:
-                if (player->state == PL_STATE_SUSPENDED)
-                {
-                    if (player->index == 0)
-                        VDP_drawTextBG(WINDOW, "1P PRESS START", PLAYER1_JOIN_TEXT_POS_X, JOIN_TEXT_POS_Y);
-                    else
-                        VDP_drawTextBG(WINDOW, "2P PRESS START", PLAYER2_JOIN_TEXT_POS_X, JOIN_TEXT_POS_Y);
-                }
-                break;
-            case JOIN_MESSAGE_VISIBLE_FRAMES:
-                if (player->state == PL_STATE_SUSPENDED)
-                {
-                    if (player->index == 0)
-                        VDP_clearTextAreaBG(WINDOW, PLAYER1_JOIN_TEXT_POS_X, JOIN_TEXT_POS_Y, JOIN_TEXT_WIDTH, 1);
-                    else
-                        VDP_clearTextAreaBG(WINDOW, PLAYER2_JOIN_TEXT_POS_X, JOIN_TEXT_POS_Y, JOIN_TEXT_WIDTH, 1);
-                }
-                break;
-            case JOIN_MESSAGE_BLINK_INTERVAL:
-                blinkCounter = 0;
-                break;
+            if (player->state == PL_STATE_SUSPENDED)
+            {
+                if (player->index == 0)
+                    Hud_DrawText("1P PRESS START", PLAYER1_JOIN_TEXT_POS_X);
+                else
+                    Hud_DrawText("2P PRESS START", PLAYER2_JOIN_TEXT_POS_X);
+            }
+        }
+        else if (blinkCounter == motion->joinVisibleFrames)
+        {
+            if (player->state == PL_STATE_SUSPENDED)
+            {
+                if (player->index == 0)
+                    Hud_ClearText(PLAYER1_JOIN_TEXT_POS_X, JOIN_TEXT_WIDTH);
+                else
+                    Hud_ClearText(PLAYER2_JOIN_TEXT_POS_X, JOIN_TEXT_WIDTH);
+            }
+        }
+        else if (blinkCounter == motion->joinBlinkInterval)
+        {
+            blinkCounter = 0;
         }
     }
 }
@@ -327,7 +517,16 @@ void Game_Render()
     BackgroundScroll();
     Game_RenderMessage();
     RenderFPS();
-    SPR_update();
+    Hud_Flush();
+    PalManager_Update();
+    Sfx_Update();
+    Music_Update();
+
+    // The probe frame is the first after an input edge, if the ship reacted to it
+    if (Input_ProbeWatch(game.players ? game.players[0].sprite : NULL))
+        Render_MarkProbe();
+
+    Render_Present();
 }
 
 // Check for new players joining the game
@@ -338,7 +537,7 @@ void Game_PlayerJoinUpdate()
         switch (player->state)
         {
             case PL_STATE_SUSPENDED:
-                if (JOY_readJoypad(player->index) & BUTTON_START)
+                if (Input_Pressed(player->index) & BUTTON_START)
                 {
                     player->lives = PLAYER_LIVES;
                     player->state = PL_STATE_DIED;
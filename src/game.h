@@ -7,10 +7,24 @@
 
 void Game_MainLoop();
 
+void Game_Frame();
+
+void Game_Update();
+
+void Game_TraceUpdate(u16 steps);
+
+u32 Game_HashState();
+
 void Projectile_UpdateEnemyCollision();
 
 void Projectile_Update();
 
+void Grid_Init();
+
+void Grid_Clear();
+
+void Grid_AddObject(GameObject *obj);
+
 void Game_Init();
 
 void Game_Render();
@@ -23,6 +37,4 @@ void Game_RenderScore(Player *player);
 
 void Game_PlayerJoinUpdate();
 
-void Game_PlayerJoinUpdate();
-
 #endif //HEADER_GAME
\ No newline at end of file
@@ -4,21 +4,12 @@
 #include <genesis.h>
 #include "game_object.h"
 #include "defs.h"
-
-// Add collision layer enum
-typedef enum {
-    COLLISION_LAYER_PLAYER = 1,
-    COLLISION_LAYER_ENEMY = 2,
-    COLLISION_LAYER_PROJECTILE = 4,
-    COLLISION_LAYER_EXPLOSION = 8
-} CollisionLayer;
-
-// Add collision mask to GameObject struct
-struct GameObject {
-    // ... existing fields ...
-    u8 collisionLayer;
-    u8 collisionMask;
-};
+#include "pal_manager.h"
+#include "vram_manager.h"
+#include "trace.h"
+#if HOST_BUILD
+#include "host_stub.h"
+#endif
 
 // Apply damage from one object to another
 void GameObject_ApplyDamageBy(GameObject *object1, GameObject *object2)
@@ -26,8 +17,9 @@ void GameObject_ApplyDamageBy(GameObject *object1, GameObject *object2)
     if (object1->hp > object2->damage)
     {
         object1->hp -= object2->damage;
-        SPR_setFrame(object1->sprite, DAMAGE_FRAME);
-        object1->blinkCounter = BLINK_TICKS;
+        // Palette attribute swap only, no frame tiles to upload
+        SPR_setPalette(object1->sprite, PalManager_GetFlashLine());
+        object1->blinkCounter = HIT_FLASH_TICKS;
     }
     else
         object1->hp = 0;
@@ -40,6 +32,7 @@ bool GameObject_CollisionUpdate(GameObject *object1, GameObject *object2)
     {
         GameObject_ApplyDamageBy(object1, object2);
         GameObject_ApplyDamageBy(object2, object1);
+        TRACE(TRACE_HIT, object1->hp, object2->hp);
         return TRUE;
     }
     return FALSE;
@@ -51,12 +44,12 @@ void GameObject_Init(GameObject *object, const SpriteDefinition *spriteDef, u16
 {
     if (!object->sprite)
     {
-        object->sprite = SPR_addSprite(spriteDef, F16_toInt(x), F16_toInt(y),
-                                       TILE_ATTR(pal, FALSE, FALSE, FALSE));
+        object->sprite = VramManager_AddSprite(spriteDef, F16_toInt(x), F16_toInt(y), pal);
     }
     else
     {
         SPR_setPosition(object->sprite, F16_toInt(x), F16_toInt(y));
+        SPR_setPalette(object->sprite, pal);
     }
     
     SPR_setVisibility(object->sprite, VISIBLE);
@@ -68,22 +61,29 @@ void GameObject_Init(GameObject *object, const SpriteDefinition *spriteDef, u16
     object->h = h;
     object->hp = hp;
     object->damage = damage;
+    object->palette = pal;
+    object->blinkCounter = 0;
+}
+
+// Count down the hit flash and restore the object palette when it ends
+void GameObject_UpdateFlash(GameObject *object)
+{
+    if (object->blinkCounter && --object->blinkCounter == 0)
+        SPR_setPalette(object->sprite, object->palette);
 }
 
 // Release game object back to pool
 void GameObject_Release(GameObject *gameObject, Pool *pool)
 {
+    TRACE(TRACE_RELEASE, F16_toInt(gameObject->x), F16_toInt(gameObject->y));
     SPR_setVisibility(gameObject->sprite, HIDDEN);
     POOL_release(pool, gameObject, TRUE);
 }
 
-// Optimized collision check with layers
-FORCE_INLINE bool GameObject_IsCollided(GameObject *obj1, GameObject *obj2)
+// Optimized collision check, callers only test pairs that can collide
+bool GameObject_IsCollided(GameObject *obj1, GameObject *obj2)
 {
-    // Check collision layers first
-    if (!(obj1->collisionMask & obj2->collisionLayer) || 
-        !(obj2->collisionMask & obj1->collisionLayer))
-        return FALSE;
+    HOST_COUNT(collisionTests);
 
     // Fast AABB check with early exits
     if (obj1->y > obj2->y + FIX16(obj2->h) || 
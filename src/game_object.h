@@ -16,6 +16,7 @@ typedef struct GameObject
     s16 hp;                 // Hit points
     s16 damage;             // Damage dealt
     u16 blinkCounter;       // Counter for damage blink effect
+    u16 palette;            // Palette line the sprite returns to after a hit flash
 } GameObject;
 
 
@@ -31,5 +32,7 @@ void GameObject_ReleaseWithExplode(GameObject *object, Pool *pool);
 
 bool GameObject_IsCollided(GameObject *obj1, GameObject *obj2);
 
+void GameObject_UpdateFlash(GameObject *object);
+
 
 #endif  // HEADER_GAME_OBJECT
@@ -7,13 +7,14 @@
 #include "enemy.h"
 
 // Global game state with default values
-GameState game = {
+GAME_TLS GameState game = {
     .scrollRules = {
-        [0] = {.plane = BG_A, .startLineIndex = 0, .numOfLines = 9, .autoScrollSpeed = FF32(0.04)},
-        [1] = {.plane = BG_A, .startLineIndex = 9, .numOfLines = 4, .autoScrollSpeed = FF32(0.4)},
-        [2] = {.plane = BG_A, .startLineIndex = 13, .numOfLines = 4, .autoScrollSpeed = FF32(1.1)},
-        [3] = {.plane = BG_A, .startLineIndex = 17, .numOfLines = 11, .autoScrollSpeed = FF32(2)},
-        [4] = {.plane = BG_B, .startLineIndex = 0, .numOfLines = 28, .autoScrollSpeed = FF32(0.01)},
+        // Scroll speeds come from the region motion table (motion.c)
+        [0] = {.plane = BG_A, .startLineIndex = 0, .numOfLines = 9},
+        [1] = {.plane = BG_A, .startLineIndex = 9, .numOfLines = 4},
+        [2] = {.plane = BG_A, .startLineIndex = 13, .numOfLines = 4},
+        [3] = {.plane = BG_A, .startLineIndex = 17, .numOfLines = 11},
+        [4] = {.plane = BG_B, .startLineIndex = 0, .numOfLines = 28},
     },
     .playerListHead = NULL,  // Start with empty player list
     
@@ -32,14 +32,13 @@ typedef struct
     Pool *projectilePool;
     Pool *enemyPool;
     Pool *explosionPool;
-    
-    s16 lineOffsetX[SCROLL_PLANES][SCREEN_TILE_ROWS]; // Line offset buffers for scrolling
+
     const EnemySpawner lineSpawner; // Enemy spawn patterns configurations
     const EnemySpawner sinSpawner;
 } GameState;
 
 
 // Global game state with default values
-extern GameState game;
+extern GAME_TLS GameState game;
 
 #endif //HEADER_GLOBALS
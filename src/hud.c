@@ -0,0 +1,153 @@
+// Bottom window row HUD. Text and counters are kept in a RAM copy of the row,
+// only changed tiles mark the row dirty and the dirty span is sent with a single
+// queued tilemap write per frame.
+//
+
+#include <genesis.h>
+#include "hud.h"
+#include "defs.h"
+#include "render.h"
+
+#define HUD_DIGIT_TILE(digit)   (RENDER_TEXT_ATTR + TILE_FONT_INDEX + ('0' - 32) + (digit))
+#define HUD_CLEAN               HUD_WIDTH
+
+static GAME_TLS u16 hudRow[HUD_WIDTH];
+static GAME_TLS u16 dirtyMin = HUD_CLEAN;
+static GAME_TLS u16 dirtyMax = 0;
+
+// Last drawn readout values, all nibbles set so the first update draws every digit
+static GAME_TLS u16 lastFpsBcd = 0xFFFF;
+static GAME_TLS u16 lastCpuLoadBcd = 0xFFFF;
+
+
+// Extend the dirty span of the row
+static void Hud_MarkDirty(u16 from, u16 to)
+{
+    if (from < dirtyMin)
+        dirtyMin = from;
+    if (to > dirtyMax)
+        dirtyMax = to;
+}
+
+// Convert a small value (< 1000) to packed BCD with subtractions only
+static u16 Hud_ToBcd(u16 value)
+{
+    u16 hundreds = 0;
+    u16 tens = 0;
+
+    while (value >= 100)
+    {
+        value -= 100;
+        hundreds++;
+    }
+    while (value >= 10)
+    {
+        value -= 10;
+        tens++;
+    }
+
+    return (hundreds << 8) | (tens << 4) | value;
+}
+
+// Write the digits of a packed BCD value which differ from the previous one
+static void Hud_DrawDigits(u16 x, u16 numDigits, u32 oldValue, u32 newValue)
+{
+    u32 diff = oldValue ^ newValue;
+    u16 pos = x + numDigits - 1;
+
+    while (diff && numDigits--)
+    {
+        if (diff & 0xF)
+        {
+            hudRow[pos] = HUD_DIGIT_TILE(newValue & 0xF);
+            Hud_MarkDirty(pos, pos);
+        }
+
+        diff >>= 4;
+        newValue >>= 4;
+        pos--;
+    }
+}
+
+// Configure the window plane once and clear the HUD row
+void Hud_Init()
+{
+    VDP_setTextPalette(PAL0);
+    VDP_setWindowOnBottom(1);
+    VDP_setTextPlane(WINDOW);
+
+    memsetU16(hudRow, RENDER_TEXT_ATTR + TILE_FONT_INDEX, HUD_WIDTH);
+    Hud_MarkDirty(0, HUD_WIDTH - 1);
+
+#if SHOW_FPS
+    Hud_DrawText("%", FPS_CPU_LOAD_POS_X + 3);
+#endif
+    lastFpsBcd = 0xFFFF;
+    lastCpuLoadBcd = 0xFFFF;
+}
+
+// Add two packed BCD values (7 digits) without divisions
+u32 Hud_BcdAdd(u32 a, u32 b)
+{
+    u32 t1 = a + 0x06666666;
+    u32 t2 = t1 + b;
+    u32 t3 = t1 ^ b;
+    u32 t4 = t2 ^ t3;
+    u32 t5 = ~t4 & 0x11111110;
+    u32 t6 = (t5 >> 2) | (t5 >> 3);
+
+    return t2 - t6;
+}
+
+// Write a text string into the HUD row
+void Hud_DrawText(const char *str, u16 x)
+{
+    u16 pos = x;
+
+    while (*str && pos < HUD_WIDTH)
+        hudRow[pos++] = RENDER_TEXT_ATTR + TILE_FONT_INDEX + (*str++ - 32);
+
+    if (pos > x)
+        Hud_MarkDirty(x, pos - 1);
+}
+
+// Blank a run of HUD row tiles
+void Hud_ClearText(u16 x, u16 len)
+{
+    if (x + len > HUD_WIDTH)
+        len = HUD_WIDTH - x;
+
+    memsetU16(&hudRow[x], RENDER_TEXT_ATTR + TILE_FONT_INDEX, len);
+    Hud_MarkDirty(x, x + len - 1);
+}
+
+// Update the score digits that changed between two packed BCD scores
+void Hud_DrawScore(u16 x, u32 oldScore, u32 newScore)
+{
+    Hud_DrawDigits(x, HUD_SCORE_DIGITS, oldScore, newScore);
+}
+
+// Update the FPS and CPU load readout digits that changed
+void Hud_DrawStats(u16 fps, u16 cpuLoad)
+{
+    u16 fpsBcd = Hud_ToBcd(fps);
+    u16 cpuLoadBcd = Hud_ToBcd(cpuLoad);
+
+    Hud_DrawDigits(FPS_CPU_LOAD_POS_X, 3, lastCpuLoadBcd, cpuLoadBcd);
+    Hud_DrawDigits(FPS_POS_X, 2, lastFpsBcd, fpsBcd);
+
+    lastCpuLoadBcd = cpuLoadBcd;
+    lastFpsBcd = fpsBcd;
+}
+
+// Queue the dirty part of the HUD row as one tilemap write
+void Hud_Flush()
+{
+    if (dirtyMin == HUD_CLEAN)
+        return;
+
+    Render_PatchTilemap(WINDOW, dirtyMin, HUD_ROW_Y, &hudRow[dirtyMin], dirtyMax - dirtyMin + 1);
+
+    dirtyMin = HUD_CLEAN;
+    dirtyMax = 0;
+}
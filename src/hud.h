@@ -0,0 +1,20 @@
+#ifndef HEADER_HUD
+#define HEADER_HUD
+
+#include <genesis.h>
+
+void Hud_Init();
+
+u32 Hud_BcdAdd(u32 a, u32 b);
+
+void Hud_DrawText(const char *str, u16 x);
+
+void Hud_ClearText(u16 x, u16 len);
+
+void Hud_DrawScore(u16 x, u32 oldScore, u32 newScore);
+
+void Hud_DrawStats(u16 fps, u16 cpuLoad);
+
+void Hud_Flush();
+
+#endif //HEADER_HUD
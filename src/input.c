@@ -0,0 +1,421 @@
+// Joypad input of the logic steps. The vblank handler samples the joypads once per
+// vblank into one of two snapshots, with press and release edges added up until a
+// logic step takes the snapshot, so game code never touches the joypad ports and a
+// tap between two steps is not lost. Each step takes its buttons once, so a session
+// can be recorded and replayed bit-exactly. The recording keeps the buttons
+// run-length encoded and one byte of the rolling state hash per step; a replay
+// compares hashes step by step and reports the first step that differs.
+// The latency probe arms on a direction press of the first joypad and stops at the
+// vblank uploading the first frame in which the ship reacted to it: it moved faster in
+// the pressed direction than in the frame before the press, or turned. A press with no
+// reaction within INPUT_PROBE_TIMEOUT presented frames, against the screen border or
+// while respawning, or one replaced by a newer press is counted as dropped.
+//
+
+#include <genesis.h>
+#include "input.h"
+#include "defs.h"
+
+#define INPUT_MAGIC     0x494E5031  // 'INP1'
+#define INPUT_PROBE_BUTTONS     (BUTTON_UP | BUTTON_DOWN | BUTTON_LEFT | BUTTON_RIGHT)
+
+// Latency probe progress
+typedef enum
+{
+    PROBE_IDLE,
+    PROBE_ARMED,            // Edge taken by a logic step, waiting for a frame with the reaction
+    PROBE_QUEUED            // Changed frame presented, waiting for its vblank
+} InputProbeState;
+
+// Ship sprite as seen by a presented frame
+typedef struct
+{
+    s16 x;
+    s16 y;
+    s16 dx;                 // Move since the frame before
+    s16 dy;
+    s16 anim;
+} InputProbeShip;
+
+static GAME_TLS InputRecording recording;
+static GAME_TLS InputMode mode = INPUT_LIVE;
+static GAME_TLS u16 buttons[2];
+static GAME_TLS u16 pressed[2];
+static GAME_TLS u16 released[2];
+
+// Written by the vblank handler, read by logic steps
+static GAME_TLS InputSnapshot snapshots[2];
+static GAME_TLS volatile u16 front = 0;
+static GAME_TLS volatile bool taken = TRUE;
+static GAME_TLS u32 takenFrame = 0;
+
+static GAME_TLS InputProbeState probeState = PROBE_IDLE;
+static GAME_TLS u32 probeFrame = 0;
+static GAME_TLS u16 probeButtons = 0;       // Directions pressed by the edge
+static GAME_TLS u16 probeWait = 0;          // Presented frames left for the reaction
+static GAME_TLS bool probeSeen = FALSE;     // The ship was in the last presented frame
+static GAME_TLS InputProbeShip probeShip;   // Last presented frame
+static GAME_TLS InputProbeShip probeBase;   // Last presented frame before the edge
+static GAME_TLS InputLatency latency;
+
+static GAME_TLS u32 step = 0;
+static GAME_TLS u32 rollingHash = 0;
+static GAME_TLS s32 divergedStep = -1;
+
+// Replay position
+static GAME_TLS u16 runIndex = 0;
+static GAME_TLS u16 runLeft = 0;
+
+
+// Start live input with a fresh hash
+void Input_Init()
+{
+    mode = INPUT_LIVE;
+    step = 0;
+    rollingHash = 0;
+    divergedStep = -1;
+    memsetU16(buttons, 0, 2);
+    probeState = PROBE_IDLE;
+    probeSeen = FALSE;
+    memset(&latency, 0, sizeof(latency));
+}
+
+// Record the joypads from the next step on
+void Input_StartRecording()
+{
+    recording.magic = INPUT_MAGIC;
+    recording.numRuns = 0;
+    recording.numSteps = 0;
+    recording.finalHash = 0;
+
+    Input_Init();
+    mode = INPUT_RECORDING;
+}
+
+// Replay the recording from the next step on, the game must be in its boot state
+void Input_StartReplay()
+{
+    Input_Init();
+
+    if (!recording.numSteps)
+        return;
+
+    runIndex = 0;
+    runLeft = recording.numRuns ? recording.runs[0].count : 0;
+    mode = INPUT_REPLAY;
+}
+
+// Back to live input, a finished recording is saved to SRAM
+void Input_Stop()
+{
+    if (mode == INPUT_RECORDING)
+    {
+        recording.finalHash = rollingHash;
+        Input_SaveRecording();
+    }
+
+    if (mode == INPUT_REPLAY)
+    {
+        if (divergedStep < 0 && rollingHash == recording.finalHash)
+            kprintf("Replay matched, %u steps", recording.numSteps);
+        else
+            kprintf("Replay diverged at step %ld", divergedStep);
+    }
+
+    mode = INPUT_LIVE;
+}
+
+// Current input source
+InputMode Input_GetMode()
+{
+    return mode;
+}
+
+// Read the joypads into the back snapshot and make it the front one, called from the vblank handler
+void Input_Sample()
+{
+    const InputSnapshot *last = &snapshots[front];
+    InputSnapshot *next = &snapshots[front ^ 1];
+
+    JOY_update();
+
+    for (u16 joy = 0; joy < 2; joy++)
+    {
+        u16 now = JOY_readJoypad(joy);
+
+        // Edges no logic step took yet stay in the new snapshot
+        next->pressed[joy] = (now & ~last->buttons[joy]) | (taken ? 0 : last->pressed[joy]);
+        next->released[joy] = (~now & last->buttons[joy]) | (taken ? 0 : last->released[joy]);
+        next->buttons[joy] = now;
+    }
+
+    next->frame = vtimer;
+    front ^= 1;
+    taken = FALSE;
+}
+
+// Last sampled joypads, for code outside the logic steps
+const InputSnapshot *Input_GetSnapshot()
+{
+    return &snapshots[front];
+}
+
+// Buttons of a live step: the held ones, plus buttons tapped since the last snapshot taken
+static void Input_TakeSnapshot()
+{
+    InputSnapshot snapshot;
+
+    // The handler must not flip or add edges between the copy and marking it taken
+    SYS_disableInts();
+    snapshot = snapshots[front];
+    taken = TRUE;
+    SYS_enableInts();
+
+    // Catch-up steps of the same frame see held buttons only
+    if (snapshot.frame == takenFrame)
+        memsetU16(snapshot.pressed, 0, 2);
+    takenFrame = snapshot.frame;
+
+    buttons[0] = snapshot.buttons[0] | snapshot.pressed[0];
+    buttons[1] = snapshot.buttons[1] | snapshot.pressed[1];
+}
+
+// Arm the latency probe on a direction press of the first joypad, a newer press restarts an armed one
+static void Input_ProbeArm()
+{
+    if (probeState != PROBE_QUEUED && probeSeen && (pressed[0] & INPUT_PROBE_BUTTONS))
+    {
+        if (probeState == PROBE_ARMED)
+            latency.dropped++;
+
+        probeState = PROBE_ARMED;
+        probeWait = INPUT_PROBE_TIMEOUT;
+        probeFrame = (mode == INPUT_REPLAY) ? vtimer : takenFrame;
+        probeButtons = pressed[0] & INPUT_PROBE_BUTTONS;
+        probeBase = probeShip;
+    }
+}
+
+// Check if the ship of the latest frame reacted to the pressed directions
+static bool Input_ProbeReacted()
+{
+    if (probeShip.anim != probeBase.anim)
+        return TRUE;
+
+    return ((probeButtons & BUTTON_LEFT) && probeShip.dx < probeBase.dx) ||
+           ((probeButtons & BUTTON_RIGHT) && probeShip.dx > probeBase.dx) ||
+           ((probeButtons & BUTTON_UP) && probeShip.dy < probeBase.dy) ||
+           ((probeButtons & BUTTON_DOWN) && probeShip.dy > probeBase.dy);
+}
+
+// Take the buttons of this logic step
+void Input_BeginStep()
+{
+    u16 previous[2] = {buttons[0], buttons[1]};
+
+    if (mode == INPUT_REPLAY)
+    {
+        if (runLeft == 0 && runIndex + 1 < recording.numRuns)
+            runLeft = recording.runs[++runIndex].count;
+
+        if (runLeft)
+        {
+            buttons[0] = recording.runs[runIndex].buttons[0];
+            buttons[1] = recording.runs[runIndex].buttons[1];
+            runLeft--;
+        }
+    }
+    else
+        Input_TakeSnapshot();
+
+    // Step edges come from the step buttons, so a replay sees the same ones
+    for (u16 joy = 0; joy < 2; joy++)
+    {
+        pressed[joy] = buttons[joy] & ~previous[joy];
+        released[joy] = ~buttons[joy] & previous[joy];
+    }
+    Input_ProbeArm();
+
+    if (mode != INPUT_RECORDING)
+        return;
+
+    if (recording.numRuns)
+    {
+        InputRun *run = &recording.runs[recording.numRuns - 1];
+
+        if (run->buttons[0] == buttons[0] && run->buttons[1] == buttons[1] && run->count != 0xFFFF)
+        {
+            run->count++;
+            return;
+        }
+    }
+
+    // Out of runs: end the recording before this step
+    if (recording.numRuns == INPUT_MAX_RUNS)
+    {
+        Input_Stop();
+        return;
+    }
+
+    InputRun *run = &recording.runs[recording.numRuns++];
+    run->buttons[0] = buttons[0];
+    run->buttons[1] = buttons[1];
+    run->count = 1;
+}
+
+// Buttons of a joypad for this logic step
+u16 Input_Read(u16 joy)
+{
+    return buttons[joy];
+}
+
+// Buttons of a joypad pressed since the last logic step
+u16 Input_Pressed(u16 joy)
+{
+    return pressed[joy];
+}
+
+// Buttons of a joypad released since the last logic step
+u16 Input_Released(u16 joy)
+{
+    return released[joy];
+}
+
+// Fold the state after the logic step into the rolling hash
+void Input_EndStep(u32 stateHash)
+{
+    rollingHash = INPUT_HASH_MIX(rollingHash, stateHash);
+
+    if (mode == INPUT_RECORDING)
+    {
+        recording.stepHashes[recording.numSteps++] = rollingHash;
+
+        if (recording.numSteps == INPUT_MAX_STEPS)
+            Input_Stop();
+    }
+    else if (mode == INPUT_REPLAY)
+    {
+        if (divergedStep < 0 && (u8) rollingHash != recording.stepHashes[step])
+            divergedStep = step;
+
+        if (step + 1 == recording.numSteps)
+            Input_Stop();
+    }
+
+    step++;
+}
+
+// Logic steps since the input was started
+u32 Input_GetStep()
+{
+    return step;
+}
+
+// Rolling state hash of all steps so far
+u32 Input_GetHash()
+{
+    return rollingHash;
+}
+
+// First replayed step whose state differs from the recording, -1 while all matched
+s32 Input_GetDivergedStep()
+{
+    return divergedStep;
+}
+
+// Recording buffer, filled by a recording and read by a replay
+InputRecording *Input_GetRecording()
+{
+    return &recording;
+}
+
+// Store the recording in SRAM after the frame statistics
+void Input_SaveRecording()
+{
+    const u8 *data = (const u8 *) &recording;
+
+    SRAM_enable();
+    for (u32 i = 0; i < sizeof(InputRecording); i++)
+        SRAM_writeByte(INPUT_SRAM_OFFSET + i, data[i]);
+    SRAM_disable();
+}
+
+// Load the recording from SRAM, fails when none was saved
+bool Input_LoadRecording()
+{
+    u8 *data = (u8 *) &recording;
+
+    SRAM_enableRO();
+    for (u32 i = 0; i < sizeof(InputRecording); i++)
+        data[i] = SRAM_readByte(INPUT_SRAM_OFFSET + i);
+    SRAM_disable();
+
+    return recording.magic == INPUT_MAGIC && recording.numRuns <= INPUT_MAX_RUNS &&
+           recording.numSteps <= INPUT_MAX_STEPS;
+}
+
+// Check the ship sprite before a frame is presented, NULL without a ship, TRUE when the frame
+// carries the reaction the probe waits for
+bool Input_ProbeWatch(const Sprite *sprite)
+{
+    bool armed = probeState == PROBE_ARMED;
+
+    if (!sprite)
+    {
+        if (armed)
+        {
+            probeState = PROBE_IDLE;
+            latency.dropped++;
+        }
+        probeSeen = FALSE;
+        return FALSE;
+    }
+
+    probeShip.dx = probeSeen ? sprite->x - probeShip.x : 0;
+    probeShip.dy = probeSeen ? sprite->y - probeShip.y : 0;
+    probeShip.x = sprite->x;
+    probeShip.y = sprite->y;
+    probeShip.anim = sprite->animInd;
+    probeSeen = TRUE;
+
+    if (!armed)
+        return FALSE;
+
+    if (Input_ProbeReacted())
+    {
+        probeState = PROBE_QUEUED;
+        return TRUE;
+    }
+
+    // No reaction in time, the press is not measured but counted
+    if (--probeWait == 0)
+    {
+        probeState = PROBE_IDLE;
+        latency.dropped++;
+    }
+    return FALSE;
+}
+
+// The frame marked by the probe was uploaded, called from the vblank handler
+void Input_ProbeFrameSent()
+{
+    u16 frames = vtimer - probeFrame;
+
+    if (probeState != PROBE_QUEUED)
+        return;
+
+    latency.last = frames;
+    if (!latency.count || frames < latency.min)
+        latency.min = frames;
+    if (frames > latency.max)
+        latency.max = frames;
+    latency.sum += frames;
+    latency.count++;
+    probeState = PROBE_IDLE;
+}
+
+// Frames from button edge to sprite upload measured so far
+const InputLatency *Input_GetLatency()
+{
+    return &latency;
+}
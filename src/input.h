@@ -0,0 +1,99 @@
+#ifndef HEADER_INPUT
+#define HEADER_INPUT
+
+#include <genesis.h>
+#include "defs.h"
+
+// Where the buttons of a logic step come from
+typedef enum
+{
+    INPUT_LIVE,             // Joypads only
+    INPUT_RECORDING,        // Joypads, written to the recording
+    INPUT_REPLAY            // Recording, joypads are ignored
+} InputMode;
+
+// Run of logic steps with unchanged buttons on both ports
+typedef struct
+{
+    u16 buttons[2];
+    u16 count;
+} InputRun;
+
+// Joypad stream of a session and the state hash of every logic step
+typedef struct
+{
+    u32 magic;
+    u16 numRuns;
+    u16 numSteps;
+    u32 finalHash;                          // Rolling hash after the last step
+    InputRun runs[INPUT_MAX_RUNS];
+    u8 stepHashes[INPUT_MAX_STEPS];         // Low byte of the rolling hash after each step
+} InputRecording;
+
+// Joypads sampled in one vblank, with the edges since the last snapshot a logic step took
+typedef struct
+{
+    u16 buttons[2];
+    u16 pressed[2];
+    u16 released[2];
+    u32 frame;                              // vtimer of the sampling vblank
+} InputSnapshot;
+
+// Frames from a sampled button edge to the vblank uploading the ship sprite change
+typedef struct
+{
+    u16 last;
+    u16 min;
+    u16 max;
+    u32 sum;
+    u32 count;
+    u32 dropped;                            // Presses without a reaction in time
+} InputLatency;
+
+// Rotate and xor: cheap on the 68000 and a changed value changes all later hashes
+#define INPUT_HASH_MIX(hash, value)     ((((hash) << 5) | ((hash) >> 27)) ^ (u32) (value))
+
+
+void Input_Init();
+
+void Input_StartRecording();
+
+void Input_StartReplay();
+
+void Input_Stop();
+
+InputMode Input_GetMode();
+
+void Input_Sample();
+
+const InputSnapshot *Input_GetSnapshot();
+
+void Input_BeginStep();
+
+u16 Input_Read(u16 joy);
+
+u16 Input_Pressed(u16 joy);
+
+u16 Input_Released(u16 joy);
+
+void Input_EndStep(u32 stateHash);
+
+u32 Input_GetStep();
+
+u32 Input_GetHash();
+
+s32 Input_GetDivergedStep();
+
+InputRecording *Input_GetRecording();
+
+void Input_SaveRecording();
+
+bool Input_LoadRecording();
+
+bool Input_ProbeWatch(const Sprite *sprite);
+
+void Input_ProbeFrameSent();
+
+const InputLatency *Input_GetLatency();
+
+#endif //HEADER_INPUT
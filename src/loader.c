@@ -0,0 +1,164 @@
+// Staged startup loader. Background tiles and tilemaps go out as DMA batches over the
+// first vblanks with the display off, where DMA runs at full bandwidth on every line,
+// and the setup steps run one per frame while the transfers happen. Compressed data
+// is unpacked one job at a time and freed once its last batch is sent. Once both are
+// done the display comes back on and the palettes fade in from black.
+//
+
+#include <genesis.h>
+#include "loader.h"
+#include "defs.h"
+#include "pal_manager.h"
+
+static GAME_TLS LoaderJob jobs[LOADER_MAX_JOBS];
+static GAME_TLS u16 numJobs = 0;
+static GAME_TLS u16 nextJob = 0;
+static GAME_TLS u16 releasedJobs = 0;
+
+static GAME_TLS LoaderStep steps[LOADER_MAX_STEPS];
+static GAME_TLS u16 numSteps = 0;
+static GAME_TLS u16 nextStep = 0;
+
+static GAME_TLS bool loading = FALSE;
+static GAME_TLS u32 bootFrames = 0;
+
+
+// Unpack compressed data to RAM before its first batch, DMA needs it as is
+static void Loader_UnpackJob(LoaderJob *job)
+{
+    if (job->tileset && job->tileset->compression != COMPRESSION_NONE)
+    {
+        job->tileset = unpackTileSet(job->tileset, NULL);
+        job->unpacked = TRUE;
+    }
+    else if (job->tilemap && job->tilemap->compression != COMPRESSION_NONE)
+    {
+        job->tilemap = unpackTileMap(job->tilemap, NULL);
+        job->unpacked = TRUE;
+    }
+}
+
+// Free the unpacked data of a job, only once the vblank sent its last batch
+static void Loader_ReleaseJob(LoaderJob *job)
+{
+    if (job->unpacked)
+        MEM_free(job->tileset ? (void *) job->tileset : (void *) job->tilemap);
+}
+
+// Queue the next part of the current jobs, up to the byte budget of one vblank
+static void Loader_QueueBatch()
+{
+    u16 budget = LOADER_DMA_BUDGET;
+
+    while (nextJob < numJobs)
+    {
+        LoaderJob *job = &jobs[nextJob];
+        const TileSet *tileset;
+        const TileMap *tilemap;
+
+        if (!job->sent)
+            Loader_UnpackJob(job);
+        tileset = job->tileset;
+        tilemap = job->tilemap;
+
+        if (tileset && job->sent < tileset->numTile)
+        {
+            u16 num = min(tileset->numTile - job->sent, budget / 32);
+            if (!num)
+                return;
+
+            VDP_loadTileData(tileset->tiles + job->sent * 8, job->baseTile + job->sent, num, DMA_QUEUE);
+            job->sent += num;
+            budget -= num * 32;
+        }
+        else if (tilemap && job->sent < tilemap->h)
+        {
+            // Rows with the base tile applied wait in the DMA buffer until the flush
+            u16 rows = min(min(tilemap->h - job->sent, LOADER_MAX_ROWS), budget / (tilemap->w * 2));
+            if (!rows)
+                return;
+
+            VDP_setTileMapEx(job->plane, tilemap, job->baseTile, 0, job->sent, 0, job->sent, tilemap->w, rows,
+                             DMA_QUEUE);
+            job->sent += rows;
+            budget -= rows * tilemap->w * 2;
+        }
+        else
+            nextJob++;
+    }
+}
+
+// Blank the display and hold all palettes black until loading is done
+void Loader_Start()
+{
+    numJobs = 0;
+    nextJob = 0;
+    releasedJobs = 0;
+    numSteps = 0;
+    nextStep = 0;
+    bootFrames = 0;
+    loading = TRUE;
+
+    VDP_setEnable(FALSE);
+    PalManager_Blank();
+}
+
+// Stream tiles to VRAM from the given tile index
+void Loader_QueueTileSet(const TileSet *tileset, u16 index)
+{
+    if (numJobs < LOADER_MAX_JOBS)
+        jobs[numJobs++] = (LoaderJob) {tileset, NULL, FALSE, 0, index, 0};
+}
+
+// Stream a tilemap to the top left corner of a plane, like VDP_setTileMapEx
+void Loader_QueueTileMap(VDPPlane plane, const TileMap *tilemap, u16 baseTile)
+{
+    if (numJobs < LOADER_MAX_JOBS)
+        jobs[numJobs++] = (LoaderJob) {NULL, tilemap, FALSE, plane, baseTile, 0};
+}
+
+// Add setup work to run in a loading frame, steps run in the order they were added
+void Loader_AddStep(LoaderStep step)
+{
+    if (numSteps < LOADER_MAX_STEPS)
+        steps[numSteps++] = step;
+}
+
+// Run one loading frame: queue the next batch and the next setup step
+void Loader_Update()
+{
+    if (!loading)
+        return;
+
+    // Batches queued last frame went out in the vblank since
+    while (releasedJobs < nextJob)
+        Loader_ReleaseJob(&jobs[releasedJobs++]);
+
+    Loader_QueueBatch();
+    if (nextStep < numSteps)
+        steps[nextStep++]();
+
+    if (releasedJobs < numJobs || nextStep < numSteps)
+        return;
+
+    // Everything is in VRAM, the fade starts from black
+    VDP_setEnable(TRUE);
+    PalManager_FadeIn(LOADER_FADE_STEP_FRAMES);
+    loading = FALSE;
+
+    // The next frame is the first to run game logic
+    bootFrames = vtimer + 1;
+    kprintf("Boot: first interactive frame %lu frames after reset", bootFrames);
+}
+
+// Check if the startup frames are still running
+bool Loader_IsLoading()
+{
+    return loading;
+}
+
+// Frames from reset to the first interactive frame, zero while loading
+u32 Loader_GetBootFrames()
+{
+    return bootFrames;
+}
@@ -0,0 +1,35 @@
+#ifndef HEADER_LOADER
+#define HEADER_LOADER
+
+#include <genesis.h>
+
+// Setup work run in one of the loading frames
+typedef void (*LoaderStep)();
+
+// Tile set or tilemap streamed to VRAM
+typedef struct
+{
+    const TileSet *tileset;     // Tiles to send, NULL for a tilemap
+    const TileMap *tilemap;     // Tilemap to send, NULL for tiles
+    bool unpacked;              // Data is a RAM copy of compressed data, freed once sent
+    VDPPlane plane;
+    u16 baseTile;               // First tile, or tile attributes and index added to tilemap entries
+    u16 sent;                   // Tiles or tilemap rows sent
+} LoaderJob;
+
+
+void Loader_Start();
+
+void Loader_QueueTileSet(const TileSet *tileset, u16 index);
+
+void Loader_QueueTileMap(VDPPlane plane, const TileMap *tilemap, u16 baseTile);
+
+void Loader_AddStep(LoaderStep step);
+
+void Loader_Update();
+
+bool Loader_IsLoading();
+
+u32 Loader_GetBootFrames();
+
+#endif //HEADER_LOADER
@@ -19,6 +19,7 @@
 #include "enemy_type.h"
 #include "explosion.h"
 #include "resources.h"
+#include "microbench.h"
 
 // =============================================
 // Main Game Loop
@@ -28,6 +29,10 @@ int main(bool hardReset)
 {
     if (!hardReset)
         SYS_hardReset();
+
+#if MICROBENCH
+    Microbench_Main();
+#endif
     
     Game_Init();
     Game_MainLoop();
@@ -0,0 +1,457 @@
+// Microbenchmarks of the hot kernels: AABB tests, collision update, grid build, pool
+// allocate/release and iteration, fix16 multiply and sine, each over a range of input
+// sizes. Runs are timed in batches, the time of an empty run is taken out and the rest
+// is divided by the calls the run made.
+// The ROM build also unpacks every compressed asset and reports its decompression
+// rate in bytes per scanline, the figure to pick a codec per asset by, and measures
+// the 68000 time lost to Z80 bus contention while music and sound effects play.
+// On the console a batch starts on line 0 with interrupts off and its length is read
+// from the V counter, which gives cycles to half a scanline per batch. The host build
+// times batches with a nanosecond clock.
+//
+
+#include <genesis.h>
+#include "microbench.h"
+#include "defs.h"
+#include "game.h"
+#include "game_object.h"
+#include "arena.h"
+
+#if HOST_BUILD
+#include <time.h>
+#else
+#include "resources.h"
+#include "music.h"
+#endif
+
+// Work done by a kernel for one input size
+typedef struct
+{
+    const char *name;
+    void (*setup)(u16 size);
+    void (*run)(u16 size);
+    bool perItem;           // A run makes one call per item, else one call in total
+} MicrobenchCase;
+
+static const u16 sizes[] = {1, 4, 16, MICROBENCH_MAX_SIZE};
+
+static GameObject objects[2][MICROBENCH_MAX_SIZE];
+static fix16 values[MICROBENCH_MAX_SIZE];
+static GameObject *allocated[MICROBENCH_MAX_SIZE];
+static Pool *pool = NULL;
+static volatile s32 sink;
+
+
+// --- Setups ---
+
+// Object pairs of the first and second row, overlapping or one screen half apart
+static void Microbench_SetupPairs(u16 size, bool overlap)
+{
+    for (u16 i = 0; i < size; i++)
+    {
+        GameObject *a = &objects[0][i];
+        GameObject *b = &objects[1][i];
+
+        memset(a, 0, sizeof(GameObject));
+        memset(b, 0, sizeof(GameObject));
+        a->x = b->x = FIX16(i * 8);
+        a->y = FIX16(16);
+        b->y = overlap ? FIX16(24) : FIX16(16 + SCREEN_HEIGHT / 2);
+        a->w = a->h = b->w = b->h = OBJECT_SIZE;
+    }
+}
+
+static void Microbench_SetupApart(u16 size)
+{
+    Microbench_SetupPairs(size, FALSE);
+}
+
+// No hit points, so a hit kills without touching the sprites
+static void Microbench_SetupOverlap(u16 size)
+{
+    Microbench_SetupPairs(size, TRUE);
+}
+
+// Objects spread over the screen like an enemy wave
+static void Microbench_SetupGrid(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+    {
+        objects[0][i].x = FIX16((i * 37) % SCREEN_WIDTH);
+        objects[0][i].y = FIX16((i * 23) % SCREEN_HEIGHT);
+    }
+}
+
+static void Microbench_SetupEmptyPool(u16 size)
+{
+    POOL_reset(pool, TRUE);
+}
+
+static void Microbench_SetupFilledPool(u16 size)
+{
+    POOL_reset(pool, TRUE);
+    for (u16 i = 0; i < size; i++)
+        ((GameObject *) POOL_allocate(pool))->x = FIX16(i);
+}
+
+// Angles and factors over the whole fix16 range the game uses
+static void Microbench_SetupValues(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+        values[i] = FIX16(i * 23 % 360) - FIX16(180);
+}
+
+// --- Kernels ---
+
+static void Microbench_RunEmpty(u16 size)
+{
+}
+
+static void Microbench_RunIsCollided(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+        sink += GameObject_IsCollided(&objects[0][i], &objects[1][i]);
+}
+
+static void Microbench_RunCollisionUpdate(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+        sink += GameObject_CollisionUpdate(&objects[0][i], &objects[1][i]);
+}
+
+static void Microbench_RunGridClear(u16 size)
+{
+    Grid_Clear();
+}
+
+static void Microbench_RunGridBuild(u16 size)
+{
+    Grid_Clear();
+    for (u16 i = 0; i < size; i++)
+        Grid_AddObject(&objects[0][i]);
+}
+
+static void Microbench_RunPoolAllocRelease(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+        allocated[i] = POOL_allocate(pool);
+    for (u16 i = 0; i < size; i++)
+        POOL_release(pool, allocated[i], TRUE);
+}
+
+static void Microbench_RunPoolIterate(u16 size)
+{
+    FOREACH_ALLOCATED_IN_POOL(GameObject, object, pool)
+        sink += object->x;
+}
+
+static void Microbench_RunMul(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+        sink += F16_mul(values[i], values[size - 1 - i]);
+}
+
+static void Microbench_RunSin(u16 size)
+{
+    for (u16 i = 0; i < size; i++)
+        sink += F16_sin(values[i]);
+}
+
+// The empty run comes first, its time is the overhead taken out of the others
+static const MicrobenchCase cases[] = {
+    {"empty", Microbench_SetupValues, Microbench_RunEmpty, FALSE},
+    {"aabb_miss", Microbench_SetupApart, Microbench_RunIsCollided, TRUE},
+    {"aabb_hit", Microbench_SetupOverlap, Microbench_RunIsCollided, TRUE},
+    {"collide_miss", Microbench_SetupApart, Microbench_RunCollisionUpdate, TRUE},
+    {"collide_hit", Microbench_SetupOverlap, Microbench_RunCollisionUpdate, TRUE},
+    {"grid_clear", Microbench_SetupGrid, Microbench_RunGridClear, FALSE},
+    {"grid_build", Microbench_SetupGrid, Microbench_RunGridBuild, FALSE},
+    {"pool_alloc_release", Microbench_SetupEmptyPool, Microbench_RunPoolAllocRelease, TRUE},
+    {"pool_iterate", Microbench_SetupFilledPool, Microbench_RunPoolIterate, TRUE},
+    {"f16_mul", Microbench_SetupValues, Microbench_RunMul, TRUE},
+    {"f16_sin", Microbench_SetupValues, Microbench_RunSin, TRUE},
+};
+
+// --- Timing ---
+
+// Time of a number of runs
+static u32 Microbench_TimeBatch(const MicrobenchCase *benchCase, u16 size, u32 repeats)
+{
+#if HOST_BUILD
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (u32 i = 0; i < repeats; i++)
+        benchCase->run(size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start.tv_sec) * 1000000000UL + end.tv_nsec - start.tv_nsec;
+#else
+    SYS_disableInts();
+
+    // Start at the beginning of line 0
+    while (GET_VCOUNTER == 0);
+    while (GET_VCOUNTER != 0);
+
+    for (u32 i = 0; i < repeats; i++)
+        benchCase->run(size);
+
+    // The batch is shorter than the display, the counter does not wrap
+    u32 lines = GET_VCOUNTER;
+    SYS_enableInts();
+
+    // 3420 master clocks per line, the 68000 runs at a seventh, the last line counts half
+    return (lines * 2 + 1) * 3420 / 14;
+#endif
+}
+
+// Number of runs that make a batch long enough for the clock resolution
+static u32 Microbench_Calibrate(const MicrobenchCase *benchCase, u16 size)
+{
+#if HOST_BUILD
+    const u32 batchTime = MICROBENCH_BATCH_NS;
+#else
+    const u32 batchTime = MICROBENCH_BATCH_LINES * 3420 / 7;
+#endif
+    u32 repeats = 1;
+
+    while (repeats < 0x10000 && Microbench_TimeBatch(benchCase, size, repeats) < batchTime)
+        repeats *= 2;
+
+    return repeats;
+}
+
+// Run every kernel at every size, returns the number of results
+u16 Microbench_Run(MicrobenchResult *results, u16 maxResults)
+{
+    u16 count = 0;
+    u32 overhead[sizeof(sizes) / sizeof(sizes[0])];
+
+    if (!pool)
+        pool = POOL_create(MICROBENCH_MAX_SIZE, sizeof(GameObject));
+
+    // Runs before Game_Init, the grid cases need the grid from the session arena
+    Arena_Reset();
+    Grid_Init();
+
+    for (u16 c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        const MicrobenchCase *benchCase = &cases[c];
+
+        for (u16 s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && count < maxResults; s++)
+        {
+            MicrobenchResult *result = &results[count++];
+            u16 size = sizes[s];
+
+            benchCase->setup(size);
+            u32 repeats = Microbench_Calibrate(benchCase, size);
+
+            result->kernel = benchCase->name;
+            result->size = size;
+            result->runs = repeats * MICROBENCH_BATCHES;
+            result->time = 0;
+            for (u16 b = 0; b < MICROBENCH_BATCHES; b++)
+                result->time += Microbench_TimeBatch(benchCase, size, repeats);
+
+            // Tenths of a unit per run, less the empty run of the same size
+            u32 perRun = result->time * 10 / result->runs;
+            if (c == 0)
+                overhead[s] = perRun;
+            else
+                perRun = perRun > overhead[s] ? perRun - overhead[s] : 0;
+
+            result->perCall = benchCase->perItem ? perRun / size : perRun;
+        }
+    }
+
+    return count;
+}
+
+#if !HOST_BUILD
+// Compressed resource, a tile set or all frames of a sprite sheet together
+typedef struct
+{
+    const char *name;
+    const TileSet *tileset;
+    const SpriteDefinition *sprite;
+} MicrobenchAsset;
+
+// Unpack work of one asset part, returns the unpacked bytes
+typedef u32 MicrobenchUnpack(const MicrobenchAsset *asset);
+
+static const MicrobenchAsset assets[] = {
+    {"bgTileset", &bgTileset, NULL},
+    {"player_sprite", NULL, &player_sprite},
+    {"enemy_sprite", NULL, &enemy_sprite},
+    {"bullet_sprite", NULL, &bullet_sprite},
+    {"explosion_sprite", NULL, &explosion_sprite},
+    {"particle_sprite", NULL, &particle_sprite},
+};
+
+static u32 Microbench_UnpackTileSet(const TileSet *tileset)
+{
+    MEM_free(unpackTileSet(tileset, NULL));
+    return tileset->numTile * 32;
+}
+
+static u32 Microbench_UnpackTiles(const MicrobenchAsset *asset)
+{
+    return Microbench_UnpackTileSet(asset->tileset);
+}
+
+// Every frame once, the way a streamed sheet unpacks over its animations
+static u32 Microbench_UnpackSprite(const MicrobenchAsset *asset)
+{
+    u32 bytes = 0;
+
+    for (u16 anim = 0; anim < asset->sprite->numAnimation; anim++)
+    {
+        const Animation *animation = asset->sprite->animations[anim];
+
+        for (u16 frame = 0; frame < animation->numFrame; frame++)
+            bytes += Microbench_UnpackTileSet(animation->frames[frame]->tileset);
+    }
+
+    return bytes;
+}
+
+// Scanlines since the start frame, the vblank of a frame is counted from its first line
+static u32 Microbench_LinesSince(u32 startFrame)
+{
+    u16 frameLines = IS_PAL_SYSTEM ? 313 : 262;
+    u16 line = GET_VCOUNTER;
+    u32 frames = vtimer - startFrame;
+
+    // The vblank counter steps at the first vblank line, not at line 0
+    if (line >= SCREEN_HEIGHT && frames)
+        frames--;
+
+    return frames * frameLines + line;
+}
+
+// Unpack an asset part until the run is long enough, interrupts stay on to count frames
+static void Microbench_ReportUnpack(const MicrobenchAsset *asset, const char *part, MicrobenchUnpack *unpack)
+{
+    u32 bytes = 0;
+    u32 lines;
+
+    while (GET_VCOUNTER == 0);
+    while (GET_VCOUNTER != 0);
+
+    u32 startFrame = vtimer;
+    do
+        bytes += unpack(asset);
+    while ((lines = Microbench_LinesSince(startFrame)) < MICROBENCH_BATCH_LINES);
+
+    kprintf("  %s %s: %lu bytes in %lu lines, %lu.%lu bytes per line", asset->name, part, bytes, lines,
+            bytes / lines, bytes * 10 / lines % 10);
+}
+
+// ROM reads of the bus load workload, the 68000 waits while the Z80 owns the bus
+static u32 Microbench_ReadRom()
+{
+    const u32 *data = (const u32 *) xpcm_explosion;
+    u32 sum = 0;
+
+    for (u16 i = 0; i < 64; i++)
+        sum += data[i];
+    return sum;
+}
+
+// Workload runs done in a fixed number of frames
+static u32 Microbench_CountRuns()
+{
+    u32 runs = 0;
+
+    while (GET_VCOUNTER == 0);
+    while (GET_VCOUNTER != 0);
+
+    u32 startFrame = vtimer;
+    while (vtimer - startFrame < MICROBENCH_BUS_FRAMES)
+    {
+        sink += Microbench_ReadRom();
+        runs++;
+    }
+    return runs;
+}
+
+// Print a run count with its slowdown against the silent Z80
+static void Microbench_ReportRuns(const char *name, u32 runs, u32 idleRuns)
+{
+    u32 lost = (idleRuns - min(runs, idleRuns)) * 1000 / idleRuns;
+
+    kprintf("  %s: %lu runs, %lu.%lu%% slower, Z80 load %u%%", name, runs, lost / 10, lost % 10,
+            XGM2_getCPULoad(FALSE));
+}
+
+// 68000 time lost to the Z80 with the music and both sound effect channels playing
+static void Microbench_ReportBus()
+{
+    u32 idleRuns;
+
+    Z80_loadDriver(Z80_DRIVER_XGM2, TRUE);
+    kprintf("Z80 bus, %u frames of ROM reads:", MICROBENCH_BUS_FRAMES);
+    idleRuns = Microbench_CountRuns();
+    Microbench_ReportRuns("idle", idleRuns, idleRuns);
+
+    XGM2_load_FAR(xgm2_music, sizeof(xgm2_music));
+    XGM2_playTrack(MUSIC_STAGE1);
+    Microbench_ReportRuns("music", Microbench_CountRuns(), idleRuns);
+
+    // Both samples last longer than the measurement
+    XGM2_playPCM(xpcm_explosion, sizeof(xpcm_explosion), SFX_FIRST_CHANNEL);
+    XGM2_playPCM(xpcm_shoot, sizeof(xpcm_shoot), SFX_FIRST_CHANNEL + 1);
+    Microbench_ReportRuns("music and sfx", Microbench_CountRuns(), idleRuns);
+
+    // A driver command holds the Z80 bus while it is written
+    while (GET_VCOUNTER == 0);
+    while (GET_VCOUNTER != 0);
+
+    u32 startFrame = vtimer;
+    for (u16 i = 0; i < MICROBENCH_BUS_COMMANDS; i++)
+        XGM2_playPCM(xpcm_shoot, sizeof(xpcm_shoot), SFX_FIRST_CHANNEL + 1);
+    u32 lines = Microbench_LinesSince(startFrame);
+
+    kprintf("  pcm command: %lu.%lu lines", lines / MICROBENCH_BUS_COMMANDS,
+            lines * 10 / MICROBENCH_BUS_COMMANDS % 10);
+    XGM2_stop();
+}
+
+// Decompression rate of every asset, the run time of the vblank handler is included
+static void Microbench_ReportAssets()
+{
+    kprintf("Asset unpack:");
+    for (u16 i = 0; i < sizeof(assets) / sizeof(assets[0]); i++)
+    {
+        const MicrobenchAsset *asset = &assets[i];
+
+        if (asset->tileset)
+            Microbench_ReportUnpack(asset, "tiles", Microbench_UnpackTiles);
+        else
+            Microbench_ReportUnpack(asset, "frames", Microbench_UnpackSprite);
+    }
+}
+#endif
+
+// Print the results to the debug log
+void Microbench_Report(const MicrobenchResult *results, u16 count)
+{
+    kprintf("Microbench, " MICROBENCH_UNIT " per call:");
+    for (u16 i = 0; i < count; i++)
+        kprintf("  %s %u: %lu.%lu (%lu runs)", results[i].kernel, results[i].size, results[i].perCall / 10,
+                results[i].perCall % 10, results[i].runs);
+}
+
+// ROM entry of a MICROBENCH build, reports once and stops
+void Microbench_Main()
+{
+    static MicrobenchResult results[sizeof(cases) / sizeof(cases[0]) * sizeof(sizes) / sizeof(sizes[0])];
+
+    Microbench_Report(results, Microbench_Run(results, sizeof(results) / sizeof(results[0])));
+#if !HOST_BUILD
+    Microbench_ReportAssets();
+    Microbench_ReportBus();
+#endif
+
+    while (TRUE);
+}
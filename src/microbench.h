@@ -0,0 +1,30 @@
+#ifndef HEADER_MICROBENCH
+#define HEADER_MICROBENCH
+
+#include <genesis.h>
+#include "defs.h"
+
+#if HOST_BUILD
+#define MICROBENCH_UNIT         "ns"
+#else
+#define MICROBENCH_UNIT         "cycles"
+#endif
+
+// Time of one kernel at one input size
+typedef struct
+{
+    const char *kernel;
+    u16 size;               // Objects or values per run
+    u32 runs;               // Timed runs over all batches
+    u32 time;               // Time of all runs in MICROBENCH_UNIT
+    u32 perCall;            // Tenths of MICROBENCH_UNIT per call, run overhead taken out
+} MicrobenchResult;
+
+
+u16 Microbench_Run(MicrobenchResult *results, u16 maxResults);
+
+void Microbench_Report(const MicrobenchResult *results, u16 count);
+
+void Microbench_Main();
+
+#endif //HEADER_MICROBENCH
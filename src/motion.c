@@ -0,0 +1,75 @@
+// Region-specific motion tables. Gameplay values in defs.h are tuned for 60 Hz, the
+// 50 Hz set is derived at compile time so both live in ROM and movement code stays
+// a plain add of the selected per-frame value. Sprite animation frame times come
+// from the sprite definitions and are shortened by a frame change callback on PAL.
+//
+
+#include <genesis.h>
+#include "motion.h"
+#include "defs.h"
+#include "globals.h"
+
+// The V counter is 8 bits and jumps back in vblank: NTSC counts 0x00-0xEA then 0xE5-0xFF,
+// PAL 0x00-0xFF, 0x00-0x02 then 0xCA-0xFF. The runs start at the V-Int line, 0xE0.
+static const VCounterRun vcounterNTSC[] = {{0xE0, 11}, {0xE5, 27}, {0x00, SCREEN_HEIGHT}, {0, 0}};
+static const VCounterRun vcounterPAL[] = {{0xE0, 32}, {0x00, 3}, {0xCA, 54}, {0x00, SCREEN_HEIGHT}, {0, 0}};
+
+static const MotionTable motionNTSC = {
+    .framesPerSecond = 60,
+    .linesPerFrame = 262,
+    .vcounterRuns = vcounterNTSC,
+    .playerSpeed = PLAYER_SPEED,
+    .enemySpeed = ENEMY_SPEED,
+    .bulletSpeed = BULLET_OFFSET_X,
+    .scrollSpeed = {FF32(0.04), FF32(0.4), FF32(1.1), FF32(2), FF32(0.01)},
+    .fireRate = FIRE_RATE,
+    .invincibilityDuration = PLAYER_INVINCIBILITY_DURATION,
+    .respawnDelay = PLAYER_RESPAWN_DELAY,
+    .joinBlinkInterval = JOIN_MESSAGE_BLINK_INTERVAL,
+    .joinVisibleFrames = JOIN_MESSAGE_VISIBLE_FRAMES,
+};
+
+static const MotionTable motionPAL = {
+    .framesPerSecond = 50,
+    .linesPerFrame = 313,
+    .vcounterRuns = vcounterPAL,
+    .playerSpeed = PAL_SPEED(PLAYER_SPEED),
+    .enemySpeed = PAL_SPEED(ENEMY_SPEED),
+    .bulletSpeed = PAL_SPEED(BULLET_OFFSET_X),
+    .scrollSpeed = {PAL_SPEED(FF32(0.04)), PAL_SPEED(FF32(0.4)), PAL_SPEED(FF32(1.1)), PAL_SPEED(FF32(2)),
+                    PAL_SPEED(FF32(0.01))},
+    .fireRate = PAL_FRAMES(FIRE_RATE),
+    .invincibilityDuration = PAL_FRAMES(PLAYER_INVINCIBILITY_DURATION),
+    .respawnDelay = PAL_FRAMES(PLAYER_RESPAWN_DELAY),
+    .joinBlinkInterval = PAL_FRAMES(JOIN_MESSAGE_BLINK_INTERVAL),
+    .joinVisibleFrames = PAL_FRAMES(JOIN_MESSAGE_VISIBLE_FRAMES),
+};
+
+GAME_TLS const MotionTable *motion = &motionNTSC;
+
+
+// Select the table matching the console refresh rate
+void Motion_Init()
+{
+    motion = IS_PAL_SYSTEM ? &motionPAL : &motionNTSC;
+
+    for (u16 i = 0; i < SCROLL_PLANES; i++)
+        game.scrollRules[i].autoScrollSpeed = motion->scrollSpeed[i];
+}
+
+// Convert a 60 Hz frame count for the running region, for setup code only
+u16 Motion_Frames(u16 ntscFrames)
+{
+    return (motion == &motionPAL) ? PAL_FRAMES(ntscFrames) : ntscFrames;
+}
+
+// Frame change callback of animated sprites, converts the frame time of the new frame for the running region
+void Motion_ScaleAnimation(Sprite *sprite)
+{
+    u16 ntsc = sprite->frame->timer;
+
+    // Frame times are a few frames long: spread the remainder over the frames of the animation,
+    // a 3 frame time alternates 2 and 3, so the animation as a whole keeps its 60 Hz length
+    if (motion == &motionPAL && ntsc)
+        sprite->timer = max(1, PAL_FRAMES(ntsc * (sprite->frameInd + 1)) - PAL_FRAMES(ntsc * sprite->frameInd));
+}
@@ -0,0 +1,41 @@
+#ifndef HEADER_MOTION
+#define HEADER_MOTION
+
+#include <genesis.h>
+#include "defs.h"
+
+// Consecutive lines the V counter counts up from a value
+typedef struct
+{
+    u8 first;                               // V counter of the first line
+    u8 count;                               // Lines in the run, 0 ends the list
+} VCounterRun;
+
+// Per-frame velocities and frame timers for one video refresh rate
+typedef struct
+{
+    u16 framesPerSecond;
+    u16 linesPerFrame;                      // Scanlines per frame including vblank
+    const VCounterRun *vcounterRuns;        // V counter values from the V-Int line on, one frame
+    fix16 playerSpeed;                      // Player move per frame
+    fix16 enemySpeed;                       // Enemy and explosion drift per frame
+    fix16 bulletSpeed;                      // Bullet move per frame
+    ff32 scrollSpeed[SCROLL_PLANES];        // Background scroll per frame for each scroll rule
+    u16 fireRate;                           // Frames between shots
+    u16 invincibilityDuration;              // Frames of invincibility after respawn
+    u16 respawnDelay;                       // Frames before a dead player respawns
+    u16 joinBlinkInterval;                  // Join message blink period in frames
+    u16 joinVisibleFrames;                  // Frames the join message stays visible
+} MotionTable;
+
+
+// Table of the running region, selected once at boot
+extern GAME_TLS const MotionTable *motion;
+
+void Motion_Init();
+
+u16 Motion_Frames(u16 ntscFrames);
+
+void Motion_ScaleAnimation(Sprite *sprite);
+
+#endif //HEADER_MOTION
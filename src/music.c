@@ -0,0 +1,95 @@
+// Stage music. All tracks are one multi-track XGM2 song, loaded with the far variant of
+// the driver call so it can sit in a switched ROM bank once the ROM outgrows 4 MB and
+// ENABLE_BANK_SWITCH is set in the SGDK config. The Z80 plays it from ROM next to the
+// two sound effect channels. A track change fades the old track out over a few frames
+// and starts the new one, at most one short driver command per frame, so a change
+// never holds the main loop on the Z80.
+//
+
+#include <genesis.h>
+#include "music.h"
+#include "defs.h"
+#include "resources.h"
+
+static GAME_TLS s16 currentTrack = -1;
+static GAME_TLS s16 nextTrack = -1;
+static GAME_TLS u16 fadeTimer = 0;
+static GAME_TLS u16 waves = 0;
+static GAME_TLS u32 commands = 0;
+
+
+// Hand the song to the driver and queue the first track
+void Music_Init()
+{
+    currentTrack = -1;
+    nextTrack = -1;
+    fadeTimer = 0;
+    waves = 0;
+    commands = 0;
+
+#if PLAY_MUSIC
+    XGM2_load_FAR(xgm2_music, sizeof(xgm2_music));
+#endif
+#if DEBUG && !HOST_BUILD
+    // The converted size is only known once rescomp ran, log it and where the song ends
+    kprintf("Music: %lu bytes, ends at %lX%s", (u32) sizeof(xgm2_music), (u32) xgm2_music + sizeof(xgm2_music),
+            ((u32) xgm2_music + sizeof(xgm2_music) > MUSIC_ROM_WINDOW) ? ", past 4 MB, bank switched" : "");
+#endif
+    commands++;
+    Music_Request(MUSIC_STAGE1);
+}
+
+// Switch to a track, it starts once the current one faded out
+void Music_Request(MusicTrack track)
+{
+    nextTrack = track;
+}
+
+// Move on to the next track every few waves
+void Music_OnWaveSwitch()
+{
+    if (++waves < MUSIC_WAVES_PER_TRACK)
+        return;
+
+    waves = 0;
+    Music_Request((currentTrack + 1) % MUSIC_TRACK_COUNT);
+}
+
+// Advance a pending track change by one step, called once per frame
+void Music_Update()
+{
+    if (nextTrack == currentTrack)
+        return;
+
+    if (currentTrack >= 0 && !fadeTimer)
+    {
+        fadeTimer = MUSIC_FADE_FRAMES;
+#if PLAY_MUSIC
+        XGM2_fadeOutAndStop(MUSIC_FADE_FRAMES);
+#endif
+        commands++;
+        return;
+    }
+
+    // The driver fades on its own, the next command waits until it is done
+    if (fadeTimer && --fadeTimer)
+        return;
+
+    currentTrack = nextTrack;
+#if PLAY_MUSIC
+    XGM2_playTrack(currentTrack);
+#endif
+    commands++;
+}
+
+// Track playing or starting, -1 before the first one
+s16 Music_GetTrack()
+{
+    return currentTrack;
+}
+
+// Driver commands sent since init
+u32 Music_GetCommands()
+{
+    return commands;
+}
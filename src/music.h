@@ -0,0 +1,29 @@
+#ifndef HEADER_MUSIC
+#define HEADER_MUSIC
+
+#include <genesis.h>
+
+// Tracks of the multi-track song, in the order of resources.res
+typedef enum
+{
+    MUSIC_STAGE1,
+    MUSIC_STAGE1A,
+    MUSIC_STAGE2A,
+    MUSIC_STAGE7,
+    MUSIC_TRACK_COUNT
+} MusicTrack;
+
+
+void Music_Init();
+
+void Music_Request(MusicTrack track);
+
+void Music_OnWaveSwitch();
+
+void Music_Update();
+
+s16 Music_GetTrack();
+
+u32 Music_GetCommands();
+
+#endif //HEADER_MUSIC
@@ -0,0 +1,214 @@
+// Palette line manager. Lines are handed out per palette and ref-counted, a line
+// whose palette is acquired again stays resident and costs no CRAM write.
+// All color changes (loads and fade steps) go to a shadow CRAM and are sent
+// once per frame as a single DMA through the render buffer.
+// The hit flash has a line of its own, every sprite color turns bright on it whatever
+// sheet the sprite comes from.
+//
+
+#include <genesis.h>
+#include "pal_manager.h"
+#include "defs.h"
+#include "render.h"
+
+#define PAL_CLEAN   PAL_MANAGER_COLORS
+
+static GAME_TLS PalSlot slots[PAL_MANAGER_LINES];
+static GAME_TLS u16 shadowColors[PAL_MANAGER_COLORS];    // Colors as currently displayed
+static GAME_TLS u16 targetColors[PAL_MANAGER_COLORS];    // Colors of the assigned palettes
+static GAME_TLS u16 dirtyMin = PAL_CLEAN;
+static GAME_TLS u16 dirtyMax = 0;
+
+static GAME_TLS u16 flashLine = PAL0;
+
+static const u16 flashColors[16] =
+{
+    0, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR,
+    PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR,
+    PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR,
+    PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR, PAL_MANAGER_FLASH_COLOR
+};
+static const Palette flashPalette = {16, (u16 *) flashColors};
+
+static GAME_TLS bool fading = FALSE;
+static GAME_TLS bool blanked = FALSE;      // Lines held black until the next fade in
+static GAME_TLS bool fadeToBlack = FALSE;
+static GAME_TLS u16 fadeStepFrames = 0;
+static GAME_TLS u16 fadeTimer = 0;
+
+
+// Extend the range of shadow colors to upload
+static void PalManager_MarkDirty(u16 from, u16 to)
+{
+    if (from < dirtyMin)
+        dirtyMin = from;
+    if (to > dirtyMax)
+        dirtyMax = to;
+}
+
+// Move each RGB component of a color one level toward the goal color
+static u16 PalManager_StepColor(u16 color, u16 goal)
+{
+    for (u16 mask = 0x00E, unit = 0x002; mask; mask <<= 4, unit <<= 4)
+    {
+        u16 current = color & mask;
+        u16 wanted = goal & mask;
+
+        if (current < wanted)
+            color += unit;
+        else if (current > wanted)
+            color -= unit;
+    }
+
+    return color;
+}
+
+// Reset all lines, colors stay as they are in CRAM
+void PalManager_Init()
+{
+    memset(slots, 0, sizeof(slots));
+    memsetU16(shadowColors, 0, PAL_MANAGER_COLORS);
+    memsetU16(targetColors, 0, PAL_MANAGER_COLORS);
+    dirtyMin = PAL_CLEAN;
+    dirtyMax = 0;
+    flashLine = PAL0;
+    fading = FALSE;
+    blanked = FALSE;
+}
+
+// Assign a palette to a given line, used for lines owned by the background
+void PalManager_Load(u16 line, const Palette *palette)
+{
+    u16 first = line * 16;
+
+    slots[line].palette = palette;
+    slots[line].refCount++;
+    memcpyU16(&targetColors[first], palette->data, 16);
+
+    // A running fade picks the new colors up on its next steps
+    if (!fading && !blanked)
+    {
+        memcpyU16(&shadowColors[first], palette->data, 16);
+        PalManager_MarkDirty(first, first + 15);
+    }
+}
+
+// Get a line holding the palette, loading it into a free line when not resident
+u16 PalManager_Acquire(const Palette *palette)
+{
+    // Still resident, even if released earlier: no CRAM write needed
+    for (u16 line = PAL_MANAGER_FIRST_LINE; line < PAL_MANAGER_LINES; line++)
+    {
+        if (slots[line].palette == palette)
+        {
+            slots[line].refCount++;
+            return line;
+        }
+    }
+
+    for (u16 line = PAL_MANAGER_FIRST_LINE; line < PAL_MANAGER_LINES; line++)
+    {
+        if (slots[line].refCount == 0)
+        {
+            PalManager_Load(line, palette);
+            return line;
+        }
+    }
+
+    // Out of lines: fall back to the background line rather than corrupting one in use
+    return PAL0;
+}
+
+// Drop one reference to a line, its colors stay loaded until the line is reused
+void PalManager_Release(u16 line)
+{
+    if (slots[line].refCount)
+        slots[line].refCount--;
+}
+
+// Take a reference on the hit flash line, loading the flash colors when not resident
+u16 PalManager_AcquireFlash()
+{
+    flashLine = PalManager_Acquire(&flashPalette);
+    return flashLine;
+}
+
+// Line sprites switch to while flashing after a hit
+u16 PalManager_GetFlashLine()
+{
+    return flashLine;
+}
+
+// Set all lines to black, palettes loaded afterwards only show up with the next fade in
+void PalManager_Blank()
+{
+    memsetU16(shadowColors, 0, PAL_MANAGER_COLORS);
+    PalManager_MarkDirty(0, PAL_MANAGER_COLORS - 1);
+    fading = FALSE;
+    blanked = TRUE;
+}
+
+// Fade all lines from their current colors to the assigned palettes
+void PalManager_FadeIn(u16 stepFrames)
+{
+    if (!stepFrames)
+        stepFrames = 1;
+    
+    fading = TRUE;
+    blanked = FALSE;
+    fadeToBlack = FALSE;
+    fadeStepFrames = stepFrames;
+    fadeTimer = stepFrames;
+}
+
+// Fade all lines from their current colors to black
+void PalManager_FadeOut(u16 stepFrames)
+{
+    if (!stepFrames)
+        stepFrames = 1;
+    
+    fading = TRUE;
+    fadeToBlack = TRUE;
+    fadeStepFrames = stepFrames;
+    fadeTimer = stepFrames;
+}
+
+// Check if a fade is still running
+bool PalManager_IsFading()
+{
+    return fading;
+}
+
+// Advance fades and queue the changed shadow colors as one CRAM transfer
+void PalManager_Update()
+{
+    if (fading && --fadeTimer == 0)
+    {
+        bool changed = FALSE;
+        fadeTimer = fadeStepFrames;
+
+        for (u16 i = 0; i < PAL_MANAGER_COLORS; i++)
+        {
+            u16 color = shadowColors[i];
+            u16 stepped = PalManager_StepColor(color, fadeToBlack ? 0 : targetColors[i]);
+
+            if (stepped != color)
+            {
+                shadowColors[i] = stepped;
+                changed = TRUE;
+            }
+        }
+
+        if (changed)
+            PalManager_MarkDirty(0, PAL_MANAGER_COLORS - 1);
+        else
+            fading = FALSE;
+    }
+
+    if (dirtyMin == PAL_CLEAN)
+        return;
+
+    Render_PatchPalette(dirtyMin, &shadowColors[dirtyMin], dirtyMax - dirtyMin + 1);
+    dirtyMin = PAL_CLEAN;
+    dirtyMax = 0;
+}
@@ -0,0 +1,36 @@
+#ifndef HEADER_PAL_MANAGER
+#define HEADER_PAL_MANAGER
+
+#include <genesis.h>
+
+// Palette line bookkeeping
+typedef struct
+{
+    const Palette *palette;     // Palette currently assigned to the line
+    u16 refCount;               // Number of users, the line is free when zero
+} PalSlot;
+
+
+void PalManager_Init();
+
+void PalManager_Load(u16 line, const Palette *palette);
+
+u16 PalManager_Acquire(const Palette *palette);
+
+void PalManager_Release(u16 line);
+
+u16 PalManager_AcquireFlash();
+
+u16 PalManager_GetFlashLine();
+
+void PalManager_Blank();
+
+void PalManager_FadeIn(u16 stepFrames);
+
+void PalManager_FadeOut(u16 stepFrames);
+
+bool PalManager_IsFading();
+
+void PalManager_Update();
+
+#endif //HEADER_PAL_MANAGER
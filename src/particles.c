@@ -0,0 +1,137 @@
+// Lightweight particles for explosion debris, hit sparks and smoke. A particle is
+// only position, velocity, lifetime and tile kept in parallel arrays, live ones are
+// packed at the front so the integration loop runs without per-particle branches.
+// Each slot owns a pre-created 8x8 sprite of the resident particle sheet, drawing
+// is a position update plus a tile index switch when the look changes.
+//
+
+#include <genesis.h>
+#include "particles.h"
+#include "defs.h"
+#include "resources.h"
+#include "vram_manager.h"
+#include "scheduler.h"
+
+// Positions and velocities in 1/16 pixel
+static GAME_TLS s16 posX[MAX_PARTICLES];
+static GAME_TLS s16 posY[MAX_PARTICLES];
+static GAME_TLS s16 velX[MAX_PARTICLES];
+static GAME_TLS s16 velY[MAX_PARTICLES];
+static GAME_TLS u16 life[MAX_PARTICLES];
+static GAME_TLS u8 tile[MAX_PARTICLES];
+
+static GAME_TLS u16 numParticles = 0;
+static GAME_TLS u16 numVisible = 0;       // Sprites shown last frame
+
+static GAME_TLS Sprite *sprites[MAX_PARTICLES];
+static GAME_TLS u8 spriteTile[MAX_PARTICLES];
+
+
+// Create the particle sprites once, hidden until used
+void Particles_Init(u16 pal)
+{
+    for (u16 i = 0; i < MAX_PARTICLES; i++)
+    {
+        if (!sprites[i])
+            sprites[i] = VramManager_AddSprite(&particle_sprite, 0, 0, pal);
+
+        SPR_setVisibility(sprites[i], HIDDEN);
+        spriteTile[i] = 0;
+    }
+
+    numParticles = 0;
+    numVisible = 0;
+}
+
+// Number of particles allowed in the current frame, shrinks when the frame is overloaded
+static u16 Particles_GetCap()
+{
+    u16 cpuLoad = Scheduler_GetLoad();
+
+    if (cpuLoad >= PARTICLE_LOAD_CRITICAL)
+        return 0;
+    if (cpuLoad >= PARTICLE_LOAD_HIGH)
+        return MAX_PARTICLES / 2;
+    return MAX_PARTICLES;
+}
+
+// Spawn particles around a point with random velocities
+void Particles_Burst(ParticleType type, fix16 x, fix16 y, u16 count, u16 lifetime)
+{
+    u16 cap = Particles_GetCap();
+    s16 x16 = F16_toInt(x) * 16;
+    s16 y16 = F16_toInt(y) * 16;
+
+    while (count-- && numParticles < cap)
+    {
+        u16 i = numParticles++;
+        u16 rnd = random();
+
+        posX[i] = x16;
+        posY[i] = y16;
+        velX[i] = (s16) (rnd & 0x3F) - 32;
+        velY[i] = (s16) ((rnd >> 6) & 0x3F) - 32;
+        life[i] = lifetime + ((rnd >> 12) & 7);
+        tile[i] = type;
+    }
+}
+
+// Move particles, drop expired ones and update their sprites
+void Particles_Update()
+{
+    u16 n = numParticles;
+
+    // Branch-free integration of all live particles
+    for (u16 i = 0; i < n; i++)
+    {
+        posX[i] += velX[i];
+        posY[i] += velY[i];
+        life[i]--;
+    }
+
+    // Keep live particles packed: move the last one into each expired slot
+    for (u16 i = 0; i < n;)
+    {
+        if (life[i])
+        {
+            i++;
+            continue;
+        }
+
+        n--;
+        posX[i] = posX[n];
+        posY[i] = posY[n];
+        velX[i] = velX[n];
+        velY[i] = velY[n];
+        life[i] = life[n];
+        tile[i] = tile[n];
+    }
+    numParticles = n;
+
+    for (u16 i = 0; i < n; i++)
+    {
+        Sprite *sprite = sprites[i];
+
+        if (i >= numVisible)
+            SPR_setVisibility(sprite, AUTO_FAST);
+
+        if (spriteTile[i] != tile[i])
+        {
+            spriteTile[i] = tile[i];
+            SPR_setFrame(sprite, tile[i]);
+        }
+
+        SPR_setPosition(sprite, posX[i] >> 4, posY[i] >> 4);
+    }
+
+    for (u16 i = n; i < numVisible; i++)
+        SPR_setVisibility(sprites[i], HIDDEN);
+
+    numVisible = n;
+}
+
+// Number of live particles
+u16 Particles_GetCount()
+{
+    return numParticles;
+}
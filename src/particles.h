@@ -0,0 +1,23 @@
+#ifndef HEADER_PARTICLES
+#define HEADER_PARTICLES
+
+#include <genesis.h>
+
+// Particle look, matches the frame index in the particle sprite sheet
+typedef enum
+{
+    PARTICLE_DEBRIS,
+    PARTICLE_SPARK,
+    PARTICLE_SMOKE
+} ParticleType;
+
+
+void Particles_Init(u16 pal);
+
+void Particles_Burst(ParticleType type, fix16 x, fix16 y, u16 count, u16 lifetime);
+
+void Particles_Update();
+
+u16 Particles_GetCount();
+
+#endif //HEADER_PARTICLES
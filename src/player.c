@@ -8,26 +8,26 @@
 #include "player.h"
 #include "explosion.h"
 #include "resources.h"
+#include "hud.h"
+#include "pal_manager.h"
+#include "motion.h"
+#include "trace.h"
+#include "input.h"
+#include "sfx.h"
+#include "arena.h"
 
 
 void Players_Create()
 {
-    
+    // Allocate memory for new player, every session takes its own from the arena
+    game.players = (struct Player *) Arena_Alloc(ARENA_PLAYERS, sizeof(struct Player) * 2);
+
     if (!game.players)
-    {
-        // Allocate memory for new player
-        game.players = (struct Player *) MEM_alloc(sizeof(struct Player) * 2);
-        
-        if (!game.players)
-            return;
-        
-        // Initialize player structure
-        memset(game.players, 0, sizeof(struct Player) * 2);
-        
-        // Set player properties
-        game.players[0].index = 0;
-        game.players[1].index = 1;
-    }
+        return;
+
+    // Set player properties
+    game.players[0].index = 0;
+    game.players[1].index = 1;
 }
 
 
@@ -39,15 +39,17 @@ Player *Player_Add(u8 index)
     Player *player = &game.players[index];
     
     // Add to beginning of linked list
+    player->prev = NULL;
     player->next = game.playerListHead;
     if (game.playerListHead)
         game.playerListHead->prev = player;
     game.playerListHead = player;
     
-    PAL_setPalette(PAL1, player_sprite.palette->data, DMA);
+    // Resident after the first spawn, respawns only bump the reference count
+    u16 pal = PalManager_Acquire(player_sprite.palette);
     
     // Initialize game object properties
-    GameObject_Init((GameObject *) player, &player_sprite, PAL1,
+    GameObject_Init((GameObject *) player, &player_sprite, pal,
                     FIX16(16), FIX16(SCREEN_HEIGHT / 2 + index * 48),
                     PLAYER_WIDTH, PLAYER_HEIGHT, PLAYER_HP, PLAYER_DAMAGE);
     
@@ -56,8 +58,7 @@ Player *Player_Add(u8 index)
     SPR_setVisibility(player->sprite, AUTO_FAST);
     
     player->state = PL_STATE_INVINCIBLE;
-    // Set invincibility for 3 seconds (50 frames per second * 3 = 150 frames)
-    player->invincibleTimer = 150;
+    player->invincibleTimer = motion->invincibilityDuration;
     player->isDamageable = FALSE; // Player can't take damage during invincibility
     
     return player;
@@ -72,7 +73,8 @@ void Player_Explode(Player *player)
     player->hp = 0;
     player->state = PL_STATE_DIED;
     player->coolDownTicks = 0;
-    player->respawnTimer = PLAYER_RESPAWN_DELAY;
+    player->respawnTimer = motion->respawnDelay;
+    PalManager_Release(player->palette);
     Player_Remove(player);
     
     if (player->lives > 0)
@@ -98,6 +100,9 @@ void Player_Remove(Player *player)
     if (player->next)
         player->next->prev = player->prev;
     
+    player->prev = NULL;
+    player->next = NULL;
+    
     // Release sprite and memory
 //    SPR_releaseSprite(player->sprite);
 //    MEM_free(player);
@@ -122,8 +127,8 @@ void Player_TryShoot(Player *player)
     
     if (bullet1 || bullet2)
     {
-        XGM2_playPCM(xpcm_shoot, sizeof(xpcm_shoot), SHOOT_SOUND_CHANNEL);
-        player->coolDownTicks = FIRE_RATE;
+        Sfx_Play(SFX_SHOOT);
+        player->coolDownTicks = motion->fireRate;
     }
 }
 
@@ -131,6 +136,8 @@ void Player_TryShoot(Player *player)
 // @param player Pointer to player to update
 void Player_Update(Player *player)
 {
+    GameObject_UpdateFlash((GameObject *) player);
+    
     // Handle invincibility timer and blinking
     if (!player->isDamageable)
     {
@@ -193,24 +200,25 @@ void Player_UpdateEnemyCollision(Player *player)
 // @param player Pointer to player to update
 void Player_UpdateInput(Player *player)
 {
-    // Read controller state (JOY_1 is 0, JOY_2 is 1)
-    u16 input = JOY_readJoypad(player->index);
+    // Buttons of this logic step (JOY_1 is 0, JOY_2 is 1)
+    u16 input = Input_Read(player->index);
+    fix16 speed = motion->playerSpeed;
     
     // Handle movement
     if (input & BUTTON_LEFT)
-        player->x -= PLAYER_SPEED;
+        player->x -= speed;
     else if (input & BUTTON_RIGHT)
-        player->x += PLAYER_SPEED;
+        player->x += speed;
     
     // Handle vertical movement and animation
     if (input & BUTTON_UP)
     {
-        player->y -= PLAYER_SPEED;
+        player->y -= speed;
         SPR_setAnim(player->sprite, 1);  // Up animation
     }
     else if (input & BUTTON_DOWN)
     {
-        player->y += PLAYER_SPEED;
+        player->y += speed;
         SPR_setAnim(player->sprite, 2);  // Down animation
     }
     else
@@ -227,24 +235,19 @@ void Player_UpdateInput(Player *player)
 // Initialize a bullet object at specified position
 void Projectile_Spawn(Projectile *bullet, fix16 x, fix16 y, u8 ownerIndex)
 {
-    GameObject_Init((GameObject *) bullet, &bullet_sprite, PAL1, x, y,
+    GameObject_Init((GameObject *) bullet, &bullet_sprite, game.players[ownerIndex].palette, x, y,
                     BULLET_WIDTH, BULLET_HEIGHT, BULLET_HP, BULLET_DAMAGE);
     SPR_setAlwaysOnTop(bullet->sprite);
     bullet->ownerIndex = ownerIndex;
+    TRACE(TRACE_SPAWN_PROJECTILE, F16_toInt(x), F16_toInt(y));
 }
 
-void Player_ScoreUpdate(Player *player)
+// Add packed BCD points and redraw only the changed digits
+void Player_AddScore(Player *player, u32 points)
 {
-    if (player->index == 0)
-    {
-        static char str[5];
-        uintToStr(player->score, str, 5);
-        VDP_drawTextBG(WINDOW, str, PLAYER1_JOIN_TEXT_POS_X + 9, JOIN_TEXT_POS_Y);
-    }
-    else
-    {
-        static char str2[5];
-        uintToStr(player->score, str2, 5);
-        VDP_drawTextBG(WINDOW, str2, PLAYER2_JOIN_TEXT_POS_X + 9, JOIN_TEXT_POS_Y);
-    }
-}
\ No newline at end of file
+    u32 score = Hud_BcdAdd(player->score, points);
+    u16 x = (player->index == 0 ? PLAYER1_JOIN_TEXT_POS_X : PLAYER2_JOIN_TEXT_POS_X) + HUD_SCORE_OFFSET_X;
+    
+    Hud_DrawScore(x, player->score, score);
+    player->score = score;
+}
@@ -26,7 +26,7 @@ typedef struct Player
     struct Player *next;    // Next player in linked list
     u16 invincibleTimer;    // Timer for invincibility after respawn
     u16 respawnTimer;       // Timer for respawning
-    u16 score;
+    u32 score;              // Packed BCD score
     u8 index;               // Player index (0 or 1)
     u8 lives;
     bool isDamageable;
@@ -59,6 +59,6 @@ void Player_UpdateInput(Player *player);
 
 void Projectile_Spawn(Projectile *bullet, fix16 x, fix16 y, u8 ownerIndex);
 
-void Player_ScoreUpdate(Player *player);
+void Player_AddScore(Player *player, u32 points);
 
 #endif //HEADER_PLAYER
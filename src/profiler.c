@@ -0,0 +1,232 @@
+// Per-stage cycle profiler based on the VDP V counter. Every sample is a scanline on a
+// clock that keeps counting across vblanks, stages collect min/avg/max in scanlines.
+// Host builds have no V counter and use a nanosecond clock instead. Soak builds only
+// emit markers, the harness counts the cycles between them.
+// The V counter repeats values where it jumps back in vblank, a value is taken as the
+// earliest line at or after the last reading since the V-Int. The DMA flush stops the
+// CPU for a long stretch without readings, the V-Int handler reports its length.
+// While a stage runs the backdrop register points to the stage color, which shows
+// the stages as raster bars in the border and behind transparent plane pixels.
+//
+
+#include <genesis.h>
+#include "profiler.h"
+#include "defs.h"
+#include "motion.h"
+#include "scheduler.h"
+#include "dma_budget.h"
+#include "arena.h"
+
+#if HOST_BUILD
+#include <time.h>
+#endif
+
+// CRAM entry used as backdrop color for each stage, picked from the player and enemy lines,
+// the flash line (PAL2) is all one color
+static const u8 stageColors[PROF_STAGE_COUNT] = {
+    [PROF_INPUT] = 17,
+    [PROF_PLAYER] = 21,
+    [PROF_PROJECTILE] = 19,
+    [PROF_ENEMIES] = 62,
+    [PROF_EXPLOSIONS] = 61,
+    [PROF_COLLISION] = 60,
+    [PROF_SPAWNER] = 63,
+    [PROF_RENDER] = 26,
+};
+
+static const char *const stageNames[PROF_STAGE_COUNT] = {
+    "input", "player", "projectile", "enemies", "explosions", "collision", "spawner", "render"
+};
+
+static GAME_TLS ProfilerStats stats[PROF_STAGE_COUNT];
+static GAME_TLS u16 windowFrames = 0;
+static GAME_TLS u16 reportFrames = 0;
+
+// Last reading of the line mapping, lines since the V-Int of that vblank count
+static GAME_TLS u32 lineVBlank = 0;
+static GAME_TLS u16 minLine = 0;
+
+
+// Lines elapsed since the vertical interrupt for a V counter value read in the given vblank count
+static u16 Profiler_LinesSinceVInt(u32 vblank, u16 vcounter)
+{
+    u16 offset = 0;
+    u16 line = 0;
+
+    if (vblank != lineVBlank)
+    {
+        lineVBlank = vblank;
+        minLine = 0;
+    }
+
+    for (const VCounterRun *run = motion->vcounterRuns; run->count; run++)
+    {
+        if (vcounter >= run->first && vcounter < run->first + run->count)
+        {
+            line = offset + vcounter - run->first;
+            if (line >= minLine)
+            {
+                minLine = line;
+                return line;
+            }
+        }
+        offset += run->count;
+    }
+
+    // Behind the last reading, the latest line the value can be
+    return line;
+}
+
+// Clock of the profiler markers
+static ProfilerTime Profiler_GetTime()
+{
+#if HOST_BUILD
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ProfilerTime) (now.tv_sec * 1000000000ULL + now.tv_nsec);
+#else
+    return Profiler_GetLineClock();
+#endif
+}
+
+// Reset statistics
+void Profiler_Init()
+{
+    windowFrames = 0;
+    reportFrames = 0;
+
+    for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        memset(&stats[i], 0, sizeof(ProfilerStats));
+        stats[i].min = (ProfilerTime) ~0;
+    }
+}
+
+// Current line as lines since the V-Int, and the vblank count it belongs to
+u16 Profiler_GetLine(u32 *vblank)
+{
+    u16 vcounter;
+
+    // Retry if the interrupt hit between the two reads
+    do
+    {
+        *vblank = Scheduler_GetVBlankCount();
+        vcounter = GET_VCOUNTER;
+    }
+    while (*vblank != Scheduler_GetVBlankCount());
+
+    return Profiler_LinesSinceVInt(*vblank, vcounter);
+}
+
+// The V-Int handler flushed DMA, the CPU stood still for about the lines the bytes take
+void Profiler_SkipDma(u32 bytes)
+{
+    // Three quarters of the budget rate, so the bound stays below the real line
+    u16 lines = bytes * (motion->linesPerFrame - SCREEN_HEIGHT) * 3 / 4 / DmaBudget_GetCapacity();
+    u32 vblank = Scheduler_GetVBlankCount();
+
+    if (vblank != lineVBlank)
+    {
+        lineVBlank = vblank;
+        minLine = 0;
+    }
+    minLine = max(minLine, lines);
+}
+
+// Scanline clock, wraps at 16 bits which is far above any measured span
+u16 Profiler_GetLineClock()
+{
+    u32 vblank;
+    u16 line = Profiler_GetLine(&vblank);
+
+    return (u16) vblank * motion->linesPerFrame + line;
+}
+
+// Open a stage span
+void Profiler_Begin(ProfilerStage stage)
+{
+#if SOAK_BUILD
+    PROFILER_SOAK_MARK(stage);
+    return;
+#endif
+#if PROFILER_RASTER_BARS
+    VDP_setBackgroundColor(stageColors[stage]);
+#endif
+    stats[stage].start = Profiler_GetTime();
+}
+
+// Close a stage span, a stage can be entered several times per frame
+void Profiler_End(ProfilerStage stage)
+{
+#if SOAK_BUILD
+    PROFILER_SOAK_MARK(PROFILER_SOAK_END | stage);
+    return;
+#endif
+    stats[stage].current += Profiler_GetTime() - stats[stage].start;
+#if PROFILER_RASTER_BARS
+    VDP_setBackgroundColor(0);
+#endif
+}
+
+// Fold the frame into the statistics
+void Profiler_EndFrame()
+{
+#if SOAK_BUILD
+    PROFILER_SOAK_MARK(PROFILER_SOAK_FRAME);
+    return;
+#endif
+    bool windowDone = ++windowFrames == PROFILER_WINDOW;
+
+    for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+    {
+        ProfilerStats *stage = &stats[i];
+
+        if (stage->current < stage->min)
+            stage->min = stage->current;
+        if (stage->current > stage->max)
+            stage->max = stage->current;
+
+        stage->sum += stage->current;
+        stage->last = stage->current;
+        stage->current = 0;
+
+        if (windowDone)
+        {
+            stage->avg = stage->sum / PROFILER_WINDOW;
+            stage->sum = 0;
+        }
+    }
+
+    if (windowDone)
+        windowFrames = 0;
+
+    if (++reportFrames == PROFILER_REPORT_FRAMES)
+    {
+        reportFrames = 0;
+        Profiler_Report();
+#if DEBUG
+        // Stack headroom and arena peak as reached in play, not at boot
+        Arena_Report();
+#endif
+    }
+}
+
+// Statistics of one stage
+const ProfilerStats *Profiler_GetStats(ProfilerStage stage)
+{
+    return &stats[stage];
+}
+
+// Name of a stage for reports
+const char *Profiler_GetStageName(ProfilerStage stage)
+{
+    return stageNames[stage];
+}
+
+// Print min/avg/max scanlines of all stages to the debug log
+void Profiler_Report()
+{
+    kprintf("Stage lines (min/avg/max), missed vblanks %lu:", Scheduler_GetMissedVBlanks());
+    for (u16 i = 0; i < PROF_STAGE_COUNT; i++)
+        kprintf("  %s %u/%u/%u", stageNames[i], stats[i].min, stats[i].avg, stats[i].max);
+}
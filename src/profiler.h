@@ -0,0 +1,82 @@
+#ifndef HEADER_PROFILER
+#define HEADER_PROFILER
+
+#include <genesis.h>
+#include "defs.h"
+
+// Main loop stages measured by the profiler
+typedef enum
+{
+    PROF_INPUT,
+    PROF_PLAYER,
+    PROF_PROJECTILE,
+    PROF_ENEMIES,
+    PROF_EXPLOSIONS,
+    PROF_COLLISION,
+    PROF_SPAWNER,
+    PROF_RENDER,
+    PROF_STAGE_COUNT
+} ProfilerStage;
+
+// Console builds count scanlines, host builds nanoseconds
+#if HOST_BUILD
+typedef u32 ProfilerTime;
+#else
+typedef u16 ProfilerTime;
+#endif
+
+// Time statistics of one stage
+typedef struct
+{
+    ProfilerTime start;     // Clock at the open begin marker
+    ProfilerTime current;   // Time spent in the current frame
+    ProfilerTime last;      // Time spent in the last finished frame
+    ProfilerTime min;
+    ProfilerTime max;
+    ProfilerTime avg;       // Mean of the last PROFILER_WINDOW frames
+    u32 sum;                // Running sum for the mean
+} ProfilerStats;
+
+// Soak harness protocol: markers are written to the unused VDP register 0x1C and the
+// harness stamps each one with the 68000 cycle count (see host/soak)
+#define PROFILER_SOAK_END           0x40    // Or'ed to the stage of an end marker
+#define PROFILER_SOAK_VINT_END      0xFD    // V-Int handler done, the harness sees it start
+#define PROFILER_SOAK_FRAME         0xFF
+
+#if SOAK_BUILD
+#define PROFILER_SOAK_MARK(value)   (*(vu16 *) VDP_CTRL_PORT = 0x9C00 | (value))
+#endif
+
+
+// Begin/end markers vanish from release builds
+#if ENABLE_PROFILER
+#define PROFILE_BEGIN(stage)    Profiler_Begin(stage)
+#define PROFILE_END(stage)      Profiler_End(stage)
+#define PROFILE_FRAME_END()     Profiler_EndFrame()
+#else
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#define PROFILE_FRAME_END()
+#endif
+
+void Profiler_Init();
+
+u16 Profiler_GetLine(u32 *vblank);
+
+void Profiler_SkipDma(u32 bytes);
+
+u16 Profiler_GetLineClock();
+
+void Profiler_Begin(ProfilerStage stage);
+
+void Profiler_End(ProfilerStage stage);
+
+void Profiler_EndFrame();
+
+const ProfilerStats *Profiler_GetStats(ProfilerStage stage);
+
+const char *Profiler_GetStageName(ProfilerStage stage);
+
+void Profiler_Report();
+
+#endif //HEADER_PROFILER
@@ -0,0 +1,165 @@
+// Double-buffered render state. Frame logic writes hscroll rows and tilemap patches
+// into the back buffer, Render_Present() queues them together with the sprite table
+// and hands the frame to the V-Int handler, which flushes the DMA queue during vblank.
+// Logic of the next frame starts right away instead of waiting for the transfer.
+// Transfers are queued in DMA budget priority order, palette and patch writes the
+// vblank cannot take move on to the next back buffer.
+//
+
+#include <genesis.h>
+#include "render.h"
+#include "defs.h"
+#include "vram_manager.h"
+#include "tile_anim.h"
+#include "dma_budget.h"
+#include "trace.h"
+#include "input.h"
+#include "scheduler.h"
+#include "profiler.h"
+
+static GAME_TLS RenderBuffer buffers[2];
+static GAME_TLS RenderBuffer *backBuffer = NULL;       // Set by Render_Init
+
+// Frame waiting for its vblank upload, NULL once the V-Int handler consumed it
+static GAME_TLS RenderBuffer *volatile presentedBuffer = NULL;
+
+
+// Upload the presented frame, called from the vertical interrupt
+void Render_VBlank()
+{
+    if (!presentedBuffer)
+        return;
+
+    u32 bytes = DMA_getQueueTransferSize();
+
+    TRACE(TRACE_DMA_FLUSH, DMA_getQueueSize(), bytes);
+    DMA_flushQueue();
+    Profiler_SkipDma(bytes);
+    if (presentedBuffer->probe)
+        Input_ProbeFrameSent();
+    presentedBuffer = NULL;
+}
+
+// Reset both buffers
+void Render_Init()
+{
+    memset(buffers, 0, sizeof(buffers));
+    backBuffer = &buffers[0];
+    presentedBuffer = NULL;
+    DmaBudget_Init();
+}
+
+// Get the back buffer scroll rows of a plane
+s16 *Render_GetHScroll(VDPPlane plane)
+{
+    return (plane == BG_A) ? backBuffer->hscrollA : backBuffer->hscrollB;
+}
+
+// Copy tilemap entries into the back buffer tile pool
+static void Render_AddPatch(u16 vramAddr, const u16 *tiles, u16 len)
+{
+    if (backBuffer->numPatches == RENDER_MAX_PATCHES ||
+        backBuffer->numPatchTiles + len > RENDER_MAX_PATCH_TILES)
+        return;
+
+    TilemapPatch *patch = &backBuffer->patches[backBuffer->numPatches++];
+    patch->vramAddr = vramAddr;
+    patch->len = len;
+    patch->tiles = &backBuffer->patchTiles[backBuffer->numPatchTiles];
+    memcpyU16(patch->tiles, tiles, len);
+    backBuffer->numPatchTiles += len;
+}
+
+// Record tilemap entries to be written at the next vblank
+void Render_PatchTilemap(VDPPlane plane, u16 x, u16 y, const u16 *tiles, u16 len)
+{
+    Render_AddPatch(VDP_getPlaneAddress(plane, x, y), tiles, len);
+}
+
+// Record CRAM colors to be written at the next vblank
+void Render_PatchPalette(u16 first, const u16 *colors, u16 count)
+{
+    u16 end = first + count;
+
+    memcpyU16(&backBuffer->palette[first], colors, count);
+
+    // Merge with a range deferred from the last frame, the buffer holds all current colors
+    if (backBuffer->paletteCount)
+    {
+        first = min(first, backBuffer->paletteFirst);
+        end = max(end, backBuffer->paletteFirst + backBuffer->paletteCount);
+    }
+
+    backBuffer->paletteFirst = first;
+    backBuffer->paletteCount = end - first;
+}
+
+// Mark the back buffer as the frame the input latency probe waits for
+void Render_MarkProbe()
+{
+    backBuffer->probe = TRUE;
+}
+
+// Publish the back buffer for the next vblank and start filling the other one
+void Render_Present()
+{
+    RenderBuffer *frame = backBuffer;
+    u32 queued;
+    bool paletteSent;
+    u16 sentPatches = 0;
+
+    // Only one frame can be in flight: wait until the V-Int handler took the previous one.
+    // This is the frame lock, the upload itself happens later without the main loop.
+    while (presentedBuffer);
+
+    DmaBudget_BeginFrame();
+
+    // The sprite engine queues its table and tiles itself, it is charged what it added
+    queued = DMA_getQueueTransferSize();
+    SPR_update();
+    DmaBudget_Charge(DMA_CLASS_SPRITES, DMA_getQueueTransferSize() - queued);
+
+    // Skipped rows are still in the buffer and go out with the next frame
+    if (DmaBudget_Request(DMA_CLASS_SCROLL, SCREEN_TILE_ROWS * 4))
+    {
+        VDP_setHorizontalScrollTile(BG_A, 0, frame->hscrollA, SCREEN_TILE_ROWS, DMA_QUEUE);
+        VDP_setHorizontalScrollTile(BG_B, 0, frame->hscrollB, SCREEN_TILE_ROWS, DMA_QUEUE);
+    }
+
+    paletteSent = !frame->paletteCount || DmaBudget_Request(DMA_CLASS_PALETTE, frame->paletteCount * 2);
+    if (frame->paletteCount && paletteSent)
+        DMA_queueDma(DMA_CRAM, &frame->palette[frame->paletteFirst], frame->paletteFirst * 2, frame->paletteCount, 2);
+
+    // Frame changes of streamed sheets are known once the sprite engine ran
+    VramManager_Update();
+    TileAnim_Update();
+
+    // Patches go out in order, a later one may overwrite entries of an earlier one
+    while (sentPatches < frame->numPatches &&
+           DmaBudget_Request(DMA_CLASS_HUD, frame->patches[sentPatches].len * 2))
+    {
+        TilemapPatch *patch = &frame->patches[sentPatches++];
+        DMA_queueDma(DMA_VRAM, patch->tiles, patch->vramAddr, patch->len, 2);
+    }
+
+    DmaBudget_EndFrame();
+    presentedBuffer = frame;
+
+    // The other buffer was uploaded a frame ago and is free to reuse
+    backBuffer = (frame == &buffers[0]) ? &buffers[1] : &buffers[0];
+    // Carry scroll rows and colors over so what logic does not rewrite keeps its value
+    memcpyU16((u16 *) backBuffer->hscrollA, (u16 *) frame->hscrollA, SCREEN_TILE_ROWS);
+    memcpyU16((u16 *) backBuffer->hscrollB, (u16 *) frame->hscrollB, SCREEN_TILE_ROWS);
+    memcpyU16(backBuffer->palette, frame->palette, PAL_MANAGER_COLORS);
+    backBuffer->numPatches = 0;
+    backBuffer->numPatchTiles = 0;
+    backBuffer->probe = FALSE;
+    backBuffer->paletteFirst = frame->paletteFirst;
+    backBuffer->paletteCount = paletteSent ? 0 : frame->paletteCount;
+
+    // Patches the vblank could not take wait in front of the ones of the next frame
+    for (u16 i = sentPatches; i < frame->numPatches; i++)
+        Render_AddPatch(frame->patches[i].vramAddr, frame->patches[i].tiles, frame->patches[i].len);
+
+    Scheduler_EndFrame();
+}
@@ -0,0 +1,45 @@
+#ifndef HEADER_RENDER
+#define HEADER_RENDER
+
+#include <genesis.h>
+#include "defs.h"
+
+// Tilemap write recorded by frame logic and uploaded at the next vblank
+typedef struct
+{
+    u16 vramAddr;           // Destination address inside the plane
+    u16 len;                // Number of tilemap entries
+    u16 *tiles;             // Entries stored in the owning buffer tile pool
+} TilemapPatch;
+
+// Everything the VDP needs to display one frame
+typedef struct
+{
+    s16 hscrollA[SCREEN_TILE_ROWS];                 // Per tile row horizontal scroll of plane A
+    s16 hscrollB[SCREEN_TILE_ROWS];                 // Per tile row horizontal scroll of plane B
+    TilemapPatch patches[RENDER_MAX_PATCHES];       // Pending tilemap writes
+    u16 patchTiles[RENDER_MAX_PATCH_TILES];         // Storage for patch entries
+    u16 numPatches;
+    u16 numPatchTiles;
+    u16 palette[PAL_MANAGER_COLORS];                // CRAM colors to upload
+    u16 paletteFirst;                               // First color index of the upload
+    u16 paletteCount;                               // Number of colors, 0 when CRAM is unchanged
+    bool probe;                                     // Holds the change the input latency probe waits for
+} RenderBuffer;
+
+
+void Render_Init();
+
+s16 *Render_GetHScroll(VDPPlane plane);
+
+void Render_PatchTilemap(VDPPlane plane, u16 x, u16 y, const u16 *tiles, u16 len);
+
+void Render_PatchPalette(u16 first, const u16 *colors, u16 count);
+
+void Render_MarkProbe();
+
+void Render_Present();
+
+void Render_VBlank();
+
+#endif //HEADER_RENDER
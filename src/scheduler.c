@@ -0,0 +1,138 @@
+// Frame scheduler locked to the vertical interrupt. The V-Int handler counts vblanks
+// and uploads the presented frame, the main loop runs a fixed logic step per vblank
+// and handles vblanks it missed according to the selected policy.
+// The frame rate and CPU load are measured here as the main loop no longer runs
+// SYS_doVBlankProcess, which keeps the SGDK figures up to date: frames started per
+// second of vblanks, and scanlines from the frame start to its present.
+//
+
+#include <genesis.h>
+#include "scheduler.h"
+#include "defs.h"
+#include "render.h"
+#include "profiler.h"
+#include "input.h"
+#include "motion.h"
+
+static GAME_TLS volatile u32 vblankCount = 0;
+static GAME_TLS u32 lastVBlank = 0;
+static GAME_TLS u32 frameCount = 0;
+static GAME_TLS u32 missedVBlanks = 0;
+static GAME_TLS SchedulerPolicy schedulerPolicy = SCHEDULER_SLOWDOWN;
+
+static GAME_TLS u32 fpsWindowStart = 0;        // Vblank the frame rate window started at
+static GAME_TLS u16 fpsWindowFrames = 0;
+static GAME_TLS u16 fps = 0;
+static GAME_TLS u16 frameStartLine = 0;
+static GAME_TLS u16 loadWindowFrames = 0;
+static GAME_TLS u32 loadSum = 0;
+static GAME_TLS u16 load = 0;
+
+
+// Vertical interrupt: count the vblank, upload the presented frame and sample the joypads
+static void Scheduler_VIntCallback()
+{
+    vblankCount++;
+    Render_VBlank();
+    Input_Sample();
+#if SOAK_BUILD
+    PROFILER_SOAK_MARK(PROFILER_SOAK_VINT_END);
+#endif
+}
+
+// Install the vblank handler and start counting from the current vblank
+void Scheduler_Init(SchedulerPolicy policy)
+{
+    schedulerPolicy = policy;
+    frameCount = 0;
+    missedVBlanks = 0;
+    lastVBlank = vblankCount;
+    fpsWindowStart = vblankCount;
+    fpsWindowFrames = 0;
+    fps = motion->framesPerSecond;
+    loadWindowFrames = 0;
+    loadSum = 0;
+    load = 0;
+
+    SYS_setVIntCallback(Scheduler_VIntCallback);
+}
+
+// Wait for the next vblank and return the number of logic steps to run this frame
+u16 Scheduler_BeginFrame()
+{
+    while (vblankCount == lastVBlank);
+
+    u32 now = vblankCount;
+    u16 elapsed = now - lastVBlank;
+    lastVBlank = now;
+    frameCount++;
+    frameStartLine = Profiler_GetLineClock();
+
+    // Frames started over the last second of vblanks
+    fpsWindowFrames++;
+    if (now - fpsWindowStart >= motion->framesPerSecond)
+    {
+        fps = (u32) fpsWindowFrames * motion->framesPerSecond / (now - fpsWindowStart);
+        fpsWindowStart = now;
+        fpsWindowFrames = 0;
+    }
+
+    if (elapsed == 1)
+        return 1;
+
+    missedVBlanks += elapsed - 1;
+
+    if (schedulerPolicy == SCHEDULER_SLOWDOWN)
+        return 1;
+
+    return min(elapsed, SCHEDULER_MAX_CATCH_UP);
+}
+
+// Close the frame once it is handed to the vblank, called from Render_Present
+void Scheduler_EndFrame()
+{
+    // Lines of one frame in percent, above 100 when the frame missed its vblank
+    loadSum += (u32) (u16) (Profiler_GetLineClock() - frameStartLine) * 100 / motion->linesPerFrame;
+
+    if (++loadWindowFrames == SCHEDULER_LOAD_WINDOW)
+    {
+        load = loadSum / SCHEDULER_LOAD_WINDOW;
+        loadWindowFrames = 0;
+        loadSum = 0;
+    }
+}
+
+// Frames started per second
+u16 Scheduler_GetFps()
+{
+    return fps;
+}
+
+// CPU load of the last frames in percent
+u16 Scheduler_GetLoad()
+{
+#if HOST_BUILD
+    // Host builds have no V counter, bench sets the load with --load
+    return SYS_getCPULoad();
+#else
+    return load;
+#endif
+}
+
+// Number of frames started since init
+u32 Scheduler_GetFrame()
+{
+    return frameCount;
+}
+
+// Number of vblanks since power on
+u32 Scheduler_GetVBlankCount()
+{
+    return vblankCount;
+}
+
+// Vblanks that passed without a logic frame starting
+u32 Scheduler_GetMissedVBlanks()
+{
+    return missedVBlanks;
+}
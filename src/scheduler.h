@@ -0,0 +1,30 @@
+#ifndef HEADER_SCHEDULER
+#define HEADER_SCHEDULER
+
+#include <genesis.h>
+
+// What to do with vblanks the game logic did not keep up with
+typedef enum
+{
+    SCHEDULER_SLOWDOWN,     // One logic step per displayed frame, the game slows down
+    SCHEDULER_CATCH_UP      // Run the missed logic steps (bounded) before the next render
+} SchedulerPolicy;
+
+
+void Scheduler_Init(SchedulerPolicy policy);
+
+u16 Scheduler_BeginFrame();
+
+void Scheduler_EndFrame();
+
+u16 Scheduler_GetFps();
+
+u16 Scheduler_GetLoad();
+
+u32 Scheduler_GetFrame();
+
+u32 Scheduler_GetVBlankCount();
+
+u32 Scheduler_GetMissedVBlanks();
+
+#endif //HEADER_SCHEDULER
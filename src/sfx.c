@@ -0,0 +1,135 @@
+// Sound effect voices. Game code only requests effects, the requests of a frame are
+// merged per effect and sent in Sfx_Update() in priority order, so every PCM channel
+// gets at most one Z80 command per frame. An effect goes to an idle channel first,
+// else it replaces the lowest priority, oldest one. An effect that just started is not
+// restarted by a new request, which keeps a burst of explosions from cutting each
+// other off. Effects without high frequency content are stored at half the driver
+// rate, which halves their ROM size and the bus time the Z80 spends reading them.
+//
+
+#include <genesis.h>
+#include "sfx.h"
+#include "defs.h"
+#include "resources.h"
+#include "motion.h"
+#include "trace.h"
+
+static const SfxDefinition definitions[SFX_COUNT] = {
+    [SFX_SHOOT] = {xpcm_shoot, sizeof(xpcm_shoot), 1, FALSE},
+    [SFX_EXPLOSION] = {xpcm_explosion, sizeof(xpcm_explosion), 2, FALSE},
+};
+
+static GAME_TLS SfxVoice voices[SFX_NUM_CHANNELS];
+static GAME_TLS u16 lengthFrames[SFX_COUNT];
+static GAME_TLS u16 requested = 0;
+static GAME_TLS SfxStats stats;
+
+
+// Find the channel for an effect, -1 when all channels play something more important
+static s16 Sfx_PickVoice(u16 priority)
+{
+    s16 best = -1;
+
+    for (u16 i = 0; i < SFX_NUM_CHANNELS; i++)
+    {
+        SfxVoice *voice = &voices[i];
+
+        if (!voice->remaining)
+            return i;
+
+        // A channel takes one command per frame
+        if (!voice->age || voice->priority > priority)
+            continue;
+
+        if (best < 0 || voice->priority < voices[best].priority ||
+            (voice->priority == voices[best].priority && voice->age > voices[best].age))
+            best = i;
+    }
+
+    return best;
+}
+
+// Start an effect on a channel unless the same effect has just started
+static void Sfx_Start(u16 sfx)
+{
+    const SfxDefinition *definition = &definitions[sfx];
+    s16 channel;
+
+    for (u16 i = 0; i < SFX_NUM_CHANNELS; i++)
+    {
+        if (voices[i].remaining && voices[i].sfx == sfx && voices[i].age < SFX_RETRIGGER_FRAMES)
+            return;
+    }
+
+    channel = Sfx_PickVoice(definition->priority);
+    if (channel < 0)
+    {
+        stats.dropped++;
+        return;
+    }
+
+    voices[channel] = (SfxVoice) {sfx, definition->priority, 0, lengthFrames[sfx]};
+    stats.commands++;
+#if PLAY_SFX
+    XGM2_playPCMEx(definition->sample, definition->size, SFX_FIRST_CHANNEL + channel, definition->priority,
+                   definition->halfRate, FALSE);
+#endif
+    TRACE(TRACE_PCM, SFX_FIRST_CHANNEL + channel, definition->size);
+}
+
+// Reset the channels and get the sample lengths in frames of the video system
+void Sfx_Init()
+{
+    for (u16 i = 0; i < SFX_NUM_CHANNELS; i++)
+        voices[i] = (SfxVoice) {-1, 0, 0, 0};
+
+    for (u16 i = 0; i < SFX_COUNT; i++)
+        lengthFrames[i] = definitions[i].size * motion->framesPerSecond /
+                          (definitions[i].halfRate ? SFX_PCM_RATE / 2 : SFX_PCM_RATE) + 1;
+
+    requested = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+// Request an effect for this frame, repeated requests are merged
+void Sfx_Play(SfxId sfx)
+{
+    requested |= 1 << sfx;
+    stats.requests++;
+}
+
+// Age the channels and start the effects requested this frame, called once per frame
+void Sfx_Update()
+{
+    for (u16 i = 0; i < SFX_NUM_CHANNELS; i++)
+    {
+        SfxVoice *voice = &voices[i];
+
+        if (voice->remaining)
+        {
+            voice->remaining--;
+            voice->age++;
+        }
+    }
+
+    while (requested)
+    {
+        u16 next = 0;
+
+        for (u16 i = 1; i < SFX_COUNT; i++)
+        {
+            if ((requested & (1 << i)) &&
+                (!(requested & (1 << next)) || definitions[i].priority > definitions[next].priority))
+                next = i;
+        }
+
+        requested &= ~(1 << next);
+        Sfx_Start(next);
+    }
+}
+
+// Get the request and command counters
+const SfxStats *Sfx_GetStats()
+{
+    return &stats;
+}
@@ -0,0 +1,49 @@
+#ifndef HEADER_SFX
+#define HEADER_SFX
+
+#include <genesis.h>
+
+// Sound effects, definitions are in sfx.c
+typedef enum
+{
+    SFX_SHOOT,
+    SFX_EXPLOSION,
+    SFX_COUNT
+} SfxId;
+
+// PCM sample of a sound effect
+typedef struct
+{
+    const u8 *sample;
+    u32 size;
+    u16 priority;           // Higher cuts off lower on a busy channel
+    bool halfRate;          // Sample is at 6.65 kHz, played with the XGM2 half rate flag
+} SfxDefinition;
+
+// Sound effect playing on an XGM2 PCM channel
+typedef struct
+{
+    s16 sfx;                // Effect on the channel, -1 when idle
+    u16 priority;
+    u16 age;                // Frames since the effect started
+    u16 remaining;          // Frames until the sample ends, the channel is free at zero
+} SfxVoice;
+
+// Request and Z80 command counters since init
+typedef struct
+{
+    u32 requests;           // Sfx_Play calls
+    u32 commands;           // XGM2_playPCMEx calls
+    u32 dropped;            // Effects which found no channel
+} SfxStats;
+
+
+void Sfx_Init();
+
+void Sfx_Play(SfxId sfx);
+
+void Sfx_Update();
+
+const SfxStats *Sfx_GetStats();
+
+#endif //HEADER_SFX
@@ -0,0 +1,57 @@
+// Stress scenarios for the soak harness in host/soak. The harness writes the scenario
+// to SRAM before it boots the ROM, the game reads it once at init and replaces the wave
+// spawner or spawns explosions every logic step. Only compiled in with SOAK_BUILD.
+//
+
+#include <genesis.h>
+#include "soak.h"
+#include "defs.h"
+#include "globals.h"
+#include "enemy.h"
+#include "explosion.h"
+
+#if SOAK_BUILD
+
+// Waves that never end and spawn faster than enemies leave the screen
+static const EnemySpawner saturatedSpawners[] = {
+    {.pattern = PATTERN_HOR, .enemyCount = 0xFFFF, .delay = 0, .enemyDelay = SOAK_SPAWN_INTERVAL},
+    {.pattern = PATTERN_SIN, .enemyCount = 0xFFFF, .delay = 0, .enemyDelay = SOAK_SPAWN_INTERVAL},
+};
+
+static GAME_TLS SoakScenario scenario = SOAK_NONE;
+
+
+// Read the scenario the harness selected and set up its spawner
+void Soak_Init()
+{
+    SRAM_enableRO();
+    u32 magic = SRAM_readLong(SOAK_SRAM_OFFSET);
+    u16 selected = SRAM_readWord(SOAK_SRAM_OFFSET + 4);
+    SRAM_disable();
+
+    scenario = (magic == SOAK_MAGIC && selected < SOAK_SCENARIO_COUNT) ? selected : SOAK_NONE;
+
+    if (scenario == SOAK_WAVE_HOR)
+        EnemySpawner_Set((EnemySpawner *) &saturatedSpawners[0]);
+    else if (scenario == SOAK_WAVE_SIN)
+        EnemySpawner_Set((EnemySpawner *) &saturatedSpawners[1]);
+}
+
+// Per step work of the scenario, runs after the spawner
+void Soak_Update()
+{
+    if (scenario != SOAK_EXPLOSIONS)
+        return;
+
+    // Spread over the playfield, the pool caps the storm at MAX_EXPLOSION
+    for (u16 i = 0; i < SOAK_EXPLOSIONS_PER_STEP && POOL_getFree(game.explosionPool); i++)
+        Explosion_Spawn(FIX16(32 + random() % (SCREEN_WIDTH - 64)), FIX16(16 + random() % (SCREEN_HEIGHT - 64)));
+}
+
+// Scenario selected at init
+SoakScenario Soak_GetScenario()
+{
+    return scenario;
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef HEADER_SOAK
+#define HEADER_SOAK
+
+#include <genesis.h>
+#include "defs.h"
+
+#define SOAK_MAGIC              0x534F414BUL    // 'SOAK'
+
+// Stress scenarios of the soak harness, the harness holds fire on both pads in all of them
+typedef enum
+{
+    SOAK_NONE,          // No harness, normal game
+    SOAK_FIRE,          // Both players firing, regular waves
+    SOAK_WAVE_HOR,      // Endless PATTERN_HOR wave spawning until the enemy pool is full
+    SOAK_WAVE_SIN,      // Endless PATTERN_SIN wave spawning until the enemy pool is full
+    SOAK_EXPLOSIONS,    // Explosions spawned every step until the explosion pool is full
+    SOAK_SCENARIO_COUNT
+} SoakScenario;
+
+
+void Soak_Init();
+
+void Soak_Update();
+
+SoakScenario Soak_GetScenario();
+
+#endif //HEADER_SOAK
@@ -0,0 +1,78 @@
+// Animated background tiles. Instead of rewriting tilemap entries across a plane, the
+// pixels of the tiles themselves are replaced, so every place using a tile animates
+// with one small upload. Frame changes are queued after the sprite frames, under their
+// own byte budget and the vblank DMA budget, and wait while the sprite stream is behind.
+//
+
+#include <genesis.h>
+#include "tile_anim.h"
+#include "defs.h"
+#include "vram_manager.h"
+#include "dma_budget.h"
+
+static GAME_TLS TileAnim anims[TILE_ANIM_MAX];
+static GAME_TLS u16 numAnims = 0;
+static GAME_TLS u16 frameUploadBytes = 0;
+
+
+// Remove all animations
+void TileAnim_Init()
+{
+    numAnims = 0;
+    frameUploadBytes = 0;
+}
+
+// Animate tiles already in VRAM, starting from frame 0 which they are expected to hold
+void TileAnim_Add(const TileSet *frames, u16 vramTile, u16 frameTiles, u16 frameTicks)
+{
+    if (numAnims == TILE_ANIM_MAX)
+        return;
+
+    TileAnim *anim = &anims[numAnims++];
+    anim->frames = frames;
+    anim->vramTile = vramTile;
+    anim->frameTiles = frameTiles;
+    anim->numFrames = frames->numTile / frameTiles;
+    anim->frameTicks = frameTicks;
+    anim->timer = frameTicks;
+    anim->frame = 0;
+    anim->pending = FALSE;
+}
+
+// Advance the animations and queue the frames that changed, called after the sprite uploads
+void TileAnim_Update()
+{
+    // Sprite frames the stream could not take this frame come first
+    u16 budget = VramManager_GetDeferredUploads() ? 0 : TILE_ANIM_BUDGET;
+    frameUploadBytes = 0;
+
+    for (u16 i = 0; i < numAnims; i++)
+    {
+        TileAnim *anim = &anims[i];
+        u16 bytes = anim->frameTiles * 32;
+
+        if (!anim->pending && --anim->timer == 0)
+        {
+            anim->timer = anim->frameTicks;
+            anim->pending = TRUE;
+        }
+
+        // A late frame keeps the animation on its current one, it is not skipped over
+        if (!anim->pending || frameUploadBytes + bytes > budget || !DmaBudget_Request(DMA_CLASS_TILES, bytes))
+            continue;
+
+        if (++anim->frame == anim->numFrames)
+            anim->frame = 0;
+        anim->pending = FALSE;
+
+        VDP_loadTileData(anim->frames->tiles + anim->frame * anim->frameTiles * 8, anim->vramTile, anim->frameTiles,
+                         DMA_QUEUE);
+        frameUploadBytes += bytes;
+    }
+}
+
+// Bytes of animated tiles queued during the last update
+u16 TileAnim_GetFrameUploadBytes()
+{
+    return frameUploadBytes;
+}
@@ -0,0 +1,28 @@
+#ifndef HEADER_TILE_ANIM
+#define HEADER_TILE_ANIM
+
+#include <genesis.h>
+
+// Background tiles whose pixels cycle through the frames of a tile set
+typedef struct
+{
+    const TileSet *frames;      // All frames one after another, uncompressed to DMA from ROM
+    u16 vramTile;               // First VRAM tile replaced
+    u16 frameTiles;             // Tiles per frame
+    u16 numFrames;
+    u16 frameTicks;             // Displayed frames per animation frame
+    u16 timer;
+    u16 frame;                  // Frame currently in VRAM
+    bool pending;               // Next frame due but waiting for DMA budget
+} TileAnim;
+
+
+void TileAnim_Init();
+
+void TileAnim_Add(const TileSet *frames, u16 vramTile, u16 frameTiles, u16 frameTicks);
+
+void TileAnim_Update();
+
+u16 TileAnim_GetFrameUploadBytes();
+
+#endif //HEADER_TILE_ANIM
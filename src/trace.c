@@ -0,0 +1,82 @@
+// Event trace kept in a RAM ring buffer, the oldest records are overwritten.
+// The dump goes through the KDebug port, emulators that support it print it to
+// their log and tools/trace2chrome.py turns the log into a Chrome trace timeline.
+//
+
+#include <genesis.h>
+#include "trace.h"
+#include "defs.h"
+#include "motion.h"
+#include "profiler.h"
+
+#define TRACE_MASK  (TRACE_CAPACITY - 1)
+
+#if TRACE_CAPACITY & TRACE_MASK
+#error TRACE_CAPACITY must be a power of two
+#endif
+
+static const char *const eventNames[TRACE_EVENT_COUNT] = {
+    [TRACE_SPAWN_ENEMY] = "spawn_enemy",
+    [TRACE_SPAWN_PROJECTILE] = "spawn_projectile",
+    [TRACE_SPAWN_EXPLOSION] = "spawn_explosion",
+    [TRACE_RELEASE] = "release",
+    [TRACE_HIT] = "hit",
+    [TRACE_PCM] = "pcm",
+    [TRACE_DMA_FLUSH] = "dma_flush",
+    [TRACE_WAVE_SWITCH] = "wave_switch",
+    [TRACE_FRAME_DROP] = "frame_drop",
+};
+
+static GAME_TLS TraceRecord records[TRACE_CAPACITY];
+static GAME_TLS u16 head = 0;            // Next record to write
+static GAME_TLS u16 count = 0;
+
+
+// Clear the buffer
+void Trace_Init()
+{
+    head = 0;
+    count = 0;
+}
+
+// Append a record, called from the main loop and the V-Int handler
+void Trace_Add(TraceEvent event, u16 arg0, u16 arg1)
+{
+    TraceRecord *record;
+    u32 vblank;
+
+    // Claim the slot with interrupts off, the V-Int handler adds records too and the
+    // increment is a separate load and store; calls nest, the handler keeps its mask
+    SYS_disableInts();
+    record = &records[head];
+    head = (head + 1) & TRACE_MASK;
+    if (count < TRACE_CAPACITY)
+        count++;
+    SYS_enableInts();
+
+    record->line = Profiler_GetLine(&vblank);
+    record->frame = (u16) vblank;
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+}
+
+// Write the buffer oldest first to the debug log
+void Trace_Dump()
+{
+    u16 index = (head - count) & TRACE_MASK;
+
+    // Header lets the host script convert lines to time without knowing the build
+    kprintf("TRACE_BEGIN fps=%u lines=%u", motion->framesPerSecond, motion->linesPerFrame);
+    for (u16 i = 0; i < TRACE_EVENT_COUNT; i++)
+        kprintf("TRACE_EVENT %u %s", i, eventNames[i]);
+
+    for (u16 i = 0; i < count; i++)
+    {
+        TraceRecord *record = &records[index];
+        kprintf("TRACE %u %u %u %u %u", record->frame, record->line, record->event, record->arg0, record->arg1);
+        index = (index + 1) & TRACE_MASK;
+    }
+
+    kprintf("TRACE_END");
+}
@@ -0,0 +1,46 @@
+#ifndef HEADER_TRACE
+#define HEADER_TRACE
+
+#include <genesis.h>
+#include "defs.h"
+
+// Traced events, names for the dump are in trace.c
+typedef enum
+{
+    TRACE_SPAWN_ENEMY,          // x, y
+    TRACE_SPAWN_PROJECTILE,     // x, y
+    TRACE_SPAWN_EXPLOSION,      // x, y
+    TRACE_RELEASE,              // x, y
+    TRACE_HIT,                  // hp of both objects after the hit
+    TRACE_PCM,                  // channel, sample size
+    TRACE_DMA_FLUSH,            // queued transfers, queued bytes
+    TRACE_WAVE_SWITCH,          // new pattern, enemy count
+    TRACE_FRAME_DROP,           // missed vblanks in total, logic steps this frame
+    TRACE_EVENT_COUNT
+} TraceEvent;
+
+// One trace record, 10 bytes
+typedef struct
+{
+    u16 frame;                  // Low bits of the vblank counter
+    u16 line;                   // Lines since the V-Int, see Profiler_GetLine
+    u16 event;
+    u16 arg0;
+    u16 arg1;
+} TraceRecord;
+
+
+// Trace hooks vanish from release builds
+#if ENABLE_TRACE
+#define TRACE(event, arg0, arg1)    Trace_Add(event, arg0, arg1)
+#else
+#define TRACE(event, arg0, arg1)
+#endif
+
+void Trace_Init();
+
+void Trace_Add(TraceEvent event, u16 arg0, u16 arg1);
+
+void Trace_Dump();
+
+#endif //HEADER_TRACE
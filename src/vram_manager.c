@@ -0,0 +1,270 @@
+// Sprite sheet VRAM residency. Small, hot sheets get all frames loaded once and are
+// animated by switching the sprite tile index. Large sheets get one VRAM slot per
+// sprite and their frames are streamed into it under a per-frame upload budget. A slot
+// holds two frame buffers: a new frame goes to the one not on screen and the sprite
+// switches over once the upload is queued, until then it keeps the previous frame.
+// Sprite engine never allocates or uploads tiles for managed sheets.
+//
+
+#include <genesis.h>
+#include "vram_manager.h"
+#include "dma_budget.h"
+#include "defs.h"
+#include "motion.h"
+
+static GAME_TLS VramSheet sheets[VRAM_MAX_SHEETS];
+static GAME_TLS u16 numSheets = 0;
+static GAME_TLS u16 nextTile = 0;
+
+static GAME_TLS VramUpload uploads[VRAM_MAX_UPLOADS];
+static GAME_TLS u16 numUploads = 0;
+
+static GAME_TLS u16 frameUploadBytes = 0;
+static GAME_TLS u16 peakUploadBytes = 0;
+static GAME_TLS u16 deferredUploads = 0;
+
+
+// Find the sheet registered for a sprite definition
+static s16 VramManager_FindSheet(const SpriteDefinition *definition)
+{
+    for (u16 i = 0; i < numSheets; i++)
+    {
+        if (sheets[i].definition == definition)
+            return i;
+    }
+
+    return -1;
+}
+
+// Total tiles used by all frames of a sheet
+static u16 VramManager_CountTiles(const SpriteDefinition *definition)
+{
+    u16 total = 0;
+
+    for (u16 anim = 0; anim < definition->numAnimation; anim++)
+    {
+        const Animation *animation = definition->animations[anim];
+
+        for (u16 frame = 0; frame < animation->numFrame; frame++)
+            total += animation->frames[frame]->tileset->numTile;
+    }
+
+    return total;
+}
+
+// Queue a frame upload, a newer frame for the same buffer replaces the pending one
+static void VramManager_QueueUpload(Sprite *sprite, const TileSet *tileset, u16 tileIndex)
+{
+    for (u16 i = 0; i < numUploads; i++)
+    {
+        if (uploads[i].tileIndex == tileIndex)
+        {
+            uploads[i].tileset = tileset;
+            return;
+        }
+    }
+
+    if (numUploads == VRAM_MAX_UPLOADS)
+        return;
+
+    uploads[numUploads].sprite = sprite;
+    uploads[numUploads].tileset = tileset;
+    uploads[numUploads].tileIndex = tileIndex;
+    numUploads++;
+}
+
+// Resident sheets: point the sprite to the already loaded frame
+static void VramManager_ResidentFrameChange(Sprite *sprite)
+{
+    VramSheet *sheet = &sheets[sprite->data >> 16];
+    Motion_ScaleAnimation(sprite);
+    SPR_setVRAMTileIndex(sprite, sheet->frameTiles[sprite->animInd][sprite->frameInd]);
+}
+
+// Streamed sheets: request the new frame tiles for the slot buffer the sprite does not show
+static void VramManager_StreamedFrameChange(Sprite *sprite)
+{
+    VramSheet *sheet = &sheets[sprite->data >> 16];
+    u16 first = sheet->baseTile + (sprite->data & 0xFFFF) * 2 * sheet->slotTiles;
+    u16 shown = sprite->attribut & TILE_INDEX_MASK;
+    Motion_ScaleAnimation(sprite);
+    VramManager_QueueUpload(sprite, sprite->frame->tileset, (shown == first) ? first + sheet->slotTiles : first);
+}
+
+// Sprite whose tiles the sprite engine uploads itself
+static Sprite *VramManager_AddEngineSprite(const SpriteDefinition *definition, s16 x, s16 y, u16 pal)
+{
+    Sprite *sprite = SPR_addSprite(definition, x, y, TILE_ATTR(pal, FALSE, FALSE, FALSE));
+
+    if (sprite)
+        SPR_setFrameChangeCallback(sprite, Motion_ScaleAnimation);
+    return sprite;
+}
+
+// Start placing sheets at the given VRAM tile
+void VramManager_Init(u16 baseTile)
+{
+    numSheets = 0;
+    nextTile = baseTile;
+    numUploads = 0;
+    frameUploadBytes = 0;
+    peakUploadBytes = 0;
+    deferredUploads = 0;
+}
+
+// Reserve the VRAM region of a sprite sheet
+void VramManager_Register(const SpriteDefinition *definition, const char *name, VramPolicy policy, u16 maxSprites)
+{
+    if (numSheets == VRAM_MAX_SHEETS)
+        return;
+
+    VramSheet *sheet = &sheets[numSheets];
+    u16 totalTiles = VramManager_CountTiles(definition);
+
+    if (policy == VRAM_POLICY_AUTO)
+        policy = (totalTiles <= VRAM_RESIDENT_MAX_TILES) ? VRAM_POLICY_RESIDENT : VRAM_POLICY_STREAMED;
+
+    sheet->definition = definition;
+    sheet->name = name;
+    sheet->policy = policy;
+    sheet->baseTile = nextTile;
+    sheet->usedSlots = 0;
+
+    if (policy == VRAM_POLICY_RESIDENT)
+    {
+        sheet->frameTiles = SPR_loadAllFrames(definition, nextTile, &sheet->numTiles);
+        sheet->slotTiles = 0;
+        sheet->numSlots = 0;
+    }
+    else
+    {
+        sheet->frameTiles = NULL;
+        sheet->slotTiles = definition->maxNumTile;
+        sheet->numSlots = min(maxSprites, VRAM_MAX_SLOTS);
+        sheet->numTiles = sheet->slotTiles * 2 * sheet->numSlots;
+#if DEBUG
+        if (definition->animations[0]->frames[0]->tileset->compression != COMPRESSION_NONE)
+            kprintf("VRAM: streamed sheet %s is compressed, its frames unpack on the heap", name);
+#endif
+    }
+
+    nextTile += sheet->numTiles;
+    numSheets++;
+}
+
+// Create a sprite whose tiles are handled by the sheet policy
+Sprite *VramManager_AddSprite(const SpriteDefinition *definition, s16 x, s16 y, u16 pal)
+{
+    s16 sheetIndex = VramManager_FindSheet(definition);
+    Sprite *sprite;
+
+    // Unmanaged sheet: let the sprite engine handle it
+    if (sheetIndex < 0)
+        return VramManager_AddEngineSprite(definition, x, y, pal);
+
+    VramSheet *sheet = &sheets[sheetIndex];
+
+    // No slot left: same fallback, the frames go to the sprite engine region
+    if (sheet->policy == VRAM_POLICY_STREAMED && sheet->usedSlots == (1 << sheet->numSlots) - 1)
+        return VramManager_AddEngineSprite(definition, x, y, pal);
+
+    if (sheet->policy == VRAM_POLICY_RESIDENT)
+    {
+        sprite = SPR_addSpriteEx(definition, x, y, TILE_ATTR_FULL(pal, FALSE, FALSE, FALSE, sheet->frameTiles[0][0]),
+                                 SPR_FLAG_AUTO_VISIBILITY | SPR_FLAG_AUTO_SPRITE_ALLOC);
+        if (!sprite)
+            return NULL;
+
+        sprite->data = (u32) sheetIndex << 16;
+        SPR_setFrameChangeCallback(sprite, VramManager_ResidentFrameChange);
+        return sprite;
+    }
+
+    u16 slot = 0;
+    while (sheet->usedSlots & (1 << slot))
+        slot++;
+
+    u16 tileIndex = sheet->baseTile + slot * 2 * sheet->slotTiles;
+    sprite = SPR_addSpriteEx(definition, x, y, TILE_ATTR_FULL(pal, FALSE, FALSE, FALSE, tileIndex),
+                             SPR_FLAG_AUTO_VISIBILITY | SPR_FLAG_AUTO_SPRITE_ALLOC);
+    if (!sprite)
+        return NULL;
+
+    sheet->usedSlots |= 1 << slot;
+    sprite->data = ((u32) sheetIndex << 16) | slot;
+    SPR_setFrameChangeCallback(sprite, VramManager_StreamedFrameChange);
+    VramManager_QueueUpload(sprite, definition->animations[0]->frames[0]->tileset, tileIndex);
+    return sprite;
+}
+
+// Send queued frame uploads until the per-frame budget is spent, the rest waits
+void VramManager_Update()
+{
+    u16 done = 0;
+    frameUploadBytes = 0;
+
+    while (done < numUploads)
+    {
+        const TileSet *tileset = uploads[done].tileset;
+        u16 bytes = tileset->numTile * 32;
+
+        // Let the first upload exceed the streaming budget so an oversized frame cannot
+        // stall forever, the vblank still has to have room for it
+        if (done && frameUploadBytes + bytes > VRAM_STREAM_BUDGET)
+            break;
+        if (!DmaBudget_Request(DMA_CLASS_TILES, bytes))
+            break;
+
+        // The sprite table of this frame is already built, the switch shows from the next one
+        // on, by then the tiles are in VRAM
+        VDP_loadTileSet(tileset, uploads[done].tileIndex, DMA_QUEUE);
+        SPR_setVRAMTileIndex(uploads[done].sprite, uploads[done].tileIndex);
+        frameUploadBytes += bytes;
+        done++;
+    }
+
+    deferredUploads = numUploads - done;
+    numUploads -= done;
+
+    // Deferred uploads move to the front, ranges overlap so copy forward one by one
+    for (u16 i = 0; i < numUploads; i++)
+        uploads[i] = uploads[done + i];
+
+    if (frameUploadBytes > peakUploadBytes)
+    {
+        peakUploadBytes = frameUploadBytes;
+#if DEBUG
+        VramManager_Report();
+#endif
+    }
+}
+
+// Bytes of streamed frame tiles queued during the last update
+u16 VramManager_GetFrameUploadBytes()
+{
+    return frameUploadBytes;
+}
+
+// Streamed frames left for the next update
+u16 VramManager_GetDeferredUploads()
+{
+    return deferredUploads;
+}
+
+// Print the VRAM map of managed sheets and streaming statistics to the debug log
+void VramManager_Report()
+{
+    kprintf("VRAM map (tiles):");
+
+    for (u16 i = 0; i < numSheets; i++)
+    {
+        VramSheet *sheet = &sheets[i];
+        kprintf("  %s: %s %u-%u (%u tiles, %u slots)", sheet->name,
+                sheet->policy == VRAM_POLICY_RESIDENT ? "resident" : "streamed",
+                sheet->baseTile, sheet->baseTile + sheet->numTiles - 1, sheet->numTiles, sheet->numSlots);
+    }
+
+    kprintf("  next free tile %u", nextTile);
+    kprintf("Uploads: %u bytes last frame, %u peak, %u deferred, budget %u",
+            frameUploadBytes, peakUploadBytes, deferredUploads, VRAM_STREAM_BUDGET);
+}
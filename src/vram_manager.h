@@ -0,0 +1,51 @@
+#ifndef HEADER_VRAM_MANAGER
+#define HEADER_VRAM_MANAGER
+
+#include <genesis.h>
+
+// How the animation frames of a sprite sheet live in VRAM
+typedef enum
+{
+    VRAM_POLICY_AUTO,       // Pick resident or streamed from the sheet size
+    VRAM_POLICY_RESIDENT,   // All frames loaded once, animation only changes the tile index
+    VRAM_POLICY_STREAMED    // One double-buffered slot per sprite, frames uploaded under the per-frame budget
+} VramPolicy;
+
+// VRAM region and bookkeeping of one sprite sheet
+typedef struct
+{
+    const SpriteDefinition *definition;
+    const char *name;
+    VramPolicy policy;
+    u16 baseTile;           // First tile of the region
+    u16 numTiles;           // Tiles reserved for the region
+    u16 **frameTiles;       // Resident: VRAM tile of every [animation][frame]
+    u16 slotTiles;          // Streamed: tiles per frame buffer, a slot has two
+    u16 numSlots;           // Streamed: number of sprite slots
+    u16 usedSlots;          // Streamed: allocated slots bit mask
+} VramSheet;
+
+// Streamed frame waiting for upload
+typedef struct
+{
+    Sprite *sprite;         // Switched to the buffer once the upload is queued
+    const TileSet *tileset;
+    u16 tileIndex;
+} VramUpload;
+
+
+void VramManager_Init(u16 baseTile);
+
+void VramManager_Register(const SpriteDefinition *definition, const char *name, VramPolicy policy, u16 maxSprites);
+
+Sprite *VramManager_AddSprite(const SpriteDefinition *definition, s16 x, s16 y, u16 pal);
+
+void VramManager_Update();
+
+u16 VramManager_GetFrameUploadBytes();
+
+u16 VramManager_GetDeferredUploads();
+
+void VramManager_Report();
+
+#endif //HEADER_VRAM_MANAGER
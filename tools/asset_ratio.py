@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+#
+# Prints the packed size and compression ratio of every IMAGE, TILESET and SPRITE in
+# res/resources.res. Packed sizes come from the symbol table of the ROM build
+# (out/symbol.txt), summed over all symbols rescomp named after the resource.
+# Unpacked sizes come from the KDebug log of a MICROBENCH ROM when given, which also
+# adds the decompression rate; otherwise the tile grid of the PNG is used, an upper
+# bound since rescomp drops duplicate tiles.
+#
+# Usage: asset_ratio.py [res/resources.res] [out/symbol.txt] [--bench kdebug.log]
+#
+
+import os
+import re
+import struct
+import sys
+
+RESOURCE = re.compile(r'^\s*(IMAGE|TILESET|SPRITE)\s+(\w+)\s+"([^"]+)"\s+(.*)$')
+BENCH = re.compile(r'^\s*(\w+) (tiles|map|frames): (\d+) bytes in (\d+) lines, ([\d.]+) bytes per line')
+SYMBOL = re.compile(r'^([0-9a-fA-F]+)\s+\w\s+(\S+)$')
+
+
+def read_resources(path):
+    """Return (kind, name, png path, codec) of every image, tile set and sprite."""
+    resources = []
+    with open(path) as file:
+        for line in file:
+            match = RESOURCE.match(line)
+            if not match:
+                continue
+            kind, name, png, args = match.groups()
+            args = args.split()
+            codec = args[2] if kind == "SPRITE" else args[0]
+            resources.append((kind, name, os.path.join(os.path.dirname(path), png), codec))
+    return resources
+
+
+def read_symbol_sizes(path):
+    """Return the size of every symbol, the distance to the next address."""
+    symbols = []
+    with open(path) as file:
+        for line in file:
+            match = SYMBOL.match(line.strip())
+            if match:
+                symbols.append((int(match.group(1), 16), match.group(2)))
+
+    symbols.sort()
+    return {name: next_address - address
+            for (address, name), (next_address, _) in zip(symbols, symbols[1:])}
+
+
+def read_bench(path):
+    """Return unpacked bytes and scanlines of every asset from a MICROBENCH log."""
+    bench = {}
+    with open(path) as file:
+        for line in file:
+            match = BENCH.match(line)
+            if match:
+                name, _, size, lines, _ = match.groups()
+                total = bench.setdefault(name, [0, 0])
+                total[0] += int(size)
+                total[1] += int(lines)
+    return bench
+
+
+def png_tile_bytes(path):
+    """Size of the PNG as 4 bpp tiles."""
+    with open(path, "rb") as file:
+        width, height = struct.unpack(">2I", file.read(24)[16:24])
+    return (width // 8) * (height // 8) * 32
+
+
+def main():
+    args = sys.argv[1:]
+    bench = {}
+    if "--bench" in args:
+        index = args.index("--bench")
+        if index + 1 >= len(args):
+            sys.exit("usage: asset_ratio.py [res/resources.res] [out/symbol.txt] [--bench kdebug.log]")
+        bench = read_bench(args[index + 1])
+        del args[index:index + 2]
+
+    resources = read_resources(args[0] if args else "res/resources.res")
+    sizes = read_symbol_sizes(args[1] if len(args) > 1 else "out/symbol.txt")
+
+    print("%-18s %-6s %10s %10s %7s %10s" % ("asset", "codec", "unpacked", "packed", "ratio", "bytes/line"))
+    for kind, name, png, codec in resources:
+        packed = sum(size for symbol, size in sizes.items() if symbol.startswith(name))
+        if name in bench:
+            unpacked, lines = bench[name]
+            rate = "%10.1f" % (unpacked / lines)
+            label = "%10d" % unpacked
+        else:
+            unpacked = png_tile_bytes(png)
+            rate = "%10s" % "-"
+            label = "%9d~" % unpacked
+
+        ratio = "%6.1f%%" % (100.0 * packed / unpacked) if unpacked else "%7s" % "-"
+        print("%-18s %-6s %s %10d %s %s" % (name, codec, label, packed, ratio, rate))
+
+
+if __name__ == "__main__":
+    main()
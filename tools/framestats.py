@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+# Prints the frame statistics the game keeps in SRAM (frame_stats.c).
+# Takes an emulator save file or a cartridge SRAM dump. Both packed dumps and
+# dumps keeping the odd-address byte lane of 16-bit SRAM are accepted.
+#
+# Usage: framestats.py game.srm [--windows]
+#
+
+import struct
+import sys
+
+MAGIC = b"FSTA"
+STAGES = ("input", "player", "projectile", "enemies", "explosions", "collision", "spawner", "render")
+
+TOTALS_OFFSET = 64
+
+
+def unpack_sram(data):
+    """Return the SRAM bytes as the game addresses them."""
+    if data[:4] == MAGIC:
+        return data
+    if data[1:8:2] == MAGIC:
+        return data[1::2]
+    if data[0:8:2] == MAGIC:
+        return data[0::2]
+    sys.exit("no frame statistics found (bad magic)")
+
+
+def print_histogram(counts, bucket_lines, lines_per_frame):
+    total = sum(counts)
+    if not total:
+        print("  no frames")
+        return
+
+    peak = max(counts)
+    for bucket, count in enumerate(counts):
+        if not count:
+            continue
+        low = bucket * bucket_lines
+        label = "%4d+    " % low if bucket == len(counts) - 1 else "%4d-%-4d" % (low, low + bucket_lines - 1)
+        over = " over budget" if low >= lines_per_frame else ""
+        print("  %s %8d %6.2f%% %s%s" % (label, count, 100.0 * count / total, "#" * (40 * count // peak), over))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: framestats.py game.srm [--windows]")
+
+    with open(sys.argv[1], "rb") as file:
+        sram = unpack_sram(file.read())
+
+    version, bucket_lines, buckets, ring = struct.unpack_from(">4H", sram, 4)
+    if version >= 2:
+        lines_per_frame, fps = struct.unpack_from(">2H", sram, 12)
+        windows_written, frames = struct.unpack_from(">2I", sram, 16)
+        worst_offset = 24
+    else:
+        # Version 1 did not record the region, assume NTSC
+        lines_per_frame, fps = 262, 60
+        windows_written, frames = struct.unpack_from(">2I", sram, 12)
+        worst_offset = 20
+    print("version %d, %d frames, %d windows, %d lines per bucket, %d lines per frame at %d Hz" % (
+        version, frames, windows_written, bucket_lines, lines_per_frame, fps))
+
+    worst = struct.unpack_from(">I8H%dH" % len(STAGES), sram, worst_offset)
+    print("\nworst frame %d: %d lines" % (worst[0], worst[1]))
+    print("  enemies %d, projectiles %d, explosions %d, particles %d" % worst[2:6])
+    print("  wave pattern %d, spawned %d, dma %d bytes" % worst[6:9])
+    print("  stages: " + ", ".join("%s %d" % (name, lines) for name, lines in zip(STAGES, worst[9:])))
+
+    # The frame length of the recorded region marks the buckets that missed a vblank
+    totals = struct.unpack_from(">%dI" % buckets, sram, TOTALS_OFFSET)
+    print("\nsession histogram (lines per frame):")
+    print_histogram(totals, bucket_lines, lines_per_frame)
+
+    if "--windows" in sys.argv[2:]:
+        windows_offset = TOTALS_OFFSET + buckets * 4
+        first = max(0, windows_written - ring)
+        for window in range(first, windows_written):
+            counts = struct.unpack_from(">%dH" % buckets, sram, windows_offset + (window % ring) * buckets * 2)
+            print("\nwindow %d:" % window)
+            print_histogram(counts, bucket_lines, lines_per_frame)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+#
+# Prepares sound effect samples for the Z80 PCM drivers. Each WAV is mixed to mono,
+# leading and trailing silence is trimmed, and it is resampled to the lowest candidate
+# rate whose band keeps the sound: the energy above the new Nyquist frequency, in the
+# version the driver plays today, must stay below the limit (--min-snr, signal to
+# dropped band in dB). Optionally the result is also stored as 4-bit IMA ADPCM for a
+# driver that decodes it, half the bytes of 8-bit PCM at the same rate; its own signal
+# to noise ratio is printed, noise-like effects reach less than tonal ones.
+#
+# Prints per sample the ROM size rescomp gives it now (8-bit PCM at the driver rate,
+# padded to 256 bytes) against the new size, and the playback bus load: the Z80 reads
+# every sample byte from ROM over the 68000 bus, so bytes per frame is the load.
+# The XGM2 driver plays PCM at 13.3 kHz, or at 6.65 kHz with the half rate flag of
+# XGM2_playPCMEx; other rates only save ROM and bus time with a driver playing them.
+#
+# Writes <out>/<name>.wav (8-bit mono at the chosen rate, for a rescomp WAV resource)
+# and with --adpcm <out>/<name>.adpcm (two samples per byte, high nibble first).
+#
+# Usage: pcm_pipeline.py sample.wav [sample.wav ...] [--out dir] [--rates 13300,6650]
+#                        [--driver-rate 13300] [--silence -40] [--min-snr 20] [--adpcm]
+#
+
+import math
+import os
+import struct
+import sys
+import wave
+
+FRAME_RATE = 60
+ROM_ALIGN = 256
+FILTER_TAPS = 31
+
+IMA_STEPS = (
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97,
+    107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871,
+    5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623,
+    27086, 29794, 32767)
+IMA_INDEX = (-1, -1, -1, -1, 2, 4, 6, 8)
+
+
+def read_wav(path):
+    """Return the rate and the mono samples of a WAV as floats from -1 to 1."""
+    with wave.open(path, "rb") as file:
+        channels, width, rate, count = file.getnchannels(), file.getsampwidth(), file.getframerate(), file.getnframes()
+        data = file.readframes(count)
+
+    if width == 1:
+        values = [(value - 128) / 128.0 for value in data]
+    elif width == 2:
+        values = [value / 32768.0 for value in struct.unpack("<%dh" % (len(data) // 2), data)]
+    else:
+        sys.exit("%s: needs 8 or 16 bit samples" % path)
+
+    return rate, [sum(values[i:i + channels]) / channels for i in range(0, len(values), channels)]
+
+
+def write_wav(path, rate, samples):
+    """Write 8-bit unsigned mono samples."""
+    with wave.open(path, "wb") as file:
+        file.setnchannels(1)
+        file.setsampwidth(1)
+        file.setframerate(rate)
+        file.writeframes(bytes(min(255, max(0, int(round(value * 127)) + 128)) for value in samples))
+
+
+def trim(samples, rate, silence_db):
+    """Drop leading and trailing samples below the silence level, keeping a few ms around the sound."""
+    limit = 10 ** (silence_db / 20.0)
+    loud = [i for i, value in enumerate(samples) if abs(value) > limit]
+    if not loud:
+        return []
+
+    margin = rate // 200
+    return samples[max(0, loud[0] - margin):loud[-1] + margin + 1]
+
+
+def low_pass(samples, rate, cutoff):
+    """Windowed sinc filter, Hamming window."""
+    half = FILTER_TAPS // 2
+    fc = cutoff / rate
+    taps = []
+    for i in range(-half, half + 1):
+        sinc = 2 * fc if i == 0 else math.sin(2 * math.pi * fc * i) / (math.pi * i)
+        taps.append(sinc * (0.54 + 0.46 * math.cos(math.pi * i / half)))
+    gain = sum(taps)
+
+    padded = [0.0] * half + list(samples) + [0.0] * half
+    return [sum(tap * padded[i + j] for j, tap in enumerate(taps)) / gain for i in range(len(samples))]
+
+
+def resample(samples, rate, new_rate):
+    """Band limit to the new rate when going down, then linear interpolation."""
+    if rate == new_rate or not samples:
+        return list(samples)
+    if new_rate < rate:
+        samples = low_pass(samples, rate, new_rate * 0.45)
+
+    ratio = rate / new_rate
+    result = []
+    for i in range(int(len(samples) / ratio)):
+        pos = i * ratio
+        index = int(pos)
+        frac = pos - index
+        following = samples[index + 1] if index + 1 < len(samples) else samples[index]
+        result.append(samples[index] * (1 - frac) + following * frac)
+    return result
+
+
+def snr(reference, samples):
+    """Signal to noise ratio in dB of samples against a reference of the same rate."""
+    count = min(len(reference), len(samples))
+    signal = sum(value * value for value in reference[:count])
+    noise = sum((a - b) ** 2 for a, b in zip(reference[:count], samples[:count]))
+    if not noise:
+        return float("inf")
+    return 10 * math.log10(signal / noise) if signal else 0.0
+
+
+def encode_adpcm(samples):
+    """4-bit IMA ADPCM, two samples per byte, high nibble first. Returns the bytes and the decoded samples."""
+    predicted, index = 0, 0
+    nibbles, decoded = [], []
+    for value in samples:
+        target = int(round(value * 32767))
+        step = IMA_STEPS[index]
+        diff = target - predicted
+        code = 8 if diff < 0 else 0
+        diff = abs(diff)
+
+        delta = step >> 3
+        for bit, part in ((4, step), (2, step >> 1), (1, step >> 2)):
+            if diff >= part:
+                code |= bit
+                diff -= part
+                delta += part
+
+        predicted = max(-32768, min(32767, predicted - delta if code & 8 else predicted + delta))
+        index = max(0, min(len(IMA_STEPS) - 1, index + IMA_INDEX[code & 7]))
+        nibbles.append(code)
+        decoded.append(predicted / 32767.0)
+
+    if len(nibbles) & 1:
+        nibbles.append(0)
+    return bytes((nibbles[i] << 4) | nibbles[i + 1] for i in range(0, len(nibbles), 2)), decoded
+
+
+def rom_size(count):
+    return (count + ROM_ALIGN - 1) // ROM_ALIGN * ROM_ALIGN
+
+
+def option(args, name, default):
+    if name not in args:
+        return default
+    index = args.index(name)
+    if index + 1 >= len(args):
+        sys.exit("%s needs a value" % name)
+    value = args[index + 1]
+    del args[index:index + 2]
+    return value
+
+
+def main():
+    args = sys.argv[1:]
+    out = option(args, "--out", ".")
+    rates = sorted((int(rate) for rate in option(args, "--rates", "13300,6650").split(",")), reverse=True)
+    driver_rate = int(option(args, "--driver-rate", "13300"))
+    silence_db = float(option(args, "--silence", "-40"))
+    min_snr = float(option(args, "--min-snr", "20"))
+    adpcm = "--adpcm" in args
+    paths = [arg for arg in args if not arg.startswith("--")]
+    if not paths:
+        sys.exit("usage: pcm_pipeline.py sample.wav [sample.wav ...] [--out dir] [--rates 13300,6650] "
+                 "[--driver-rate 13300] [--silence -40] [--min-snr 20] [--adpcm]")
+
+    print("%-12s %6s %6s %6s %6s %6s %8s %8s %6s %8s %8s" % ("sample", "ms", "trim", "rate", "snr", "adpcm",
+                                                              "rom now", "rom new", "saved", "bus now", "bus new"))
+    totals = [0, 0]
+    for path in paths:
+        name = os.path.splitext(os.path.basename(path))[0]
+        rate, samples = read_wav(path)
+        trimmed = trim(samples, rate, silence_db)
+
+        # The band is judged on what the driver plays today
+        reference = resample(trimmed, rate, driver_rate)
+        chosen, chosen_snr = driver_rate, float("inf")
+        for candidate in rates:
+            if candidate >= driver_rate:
+                continue
+            quality = snr(reference, low_pass(reference, driver_rate, candidate * 0.45))
+            if quality < min_snr:
+                break
+            chosen, chosen_snr = candidate, quality
+
+        result = resample(trimmed, rate, chosen)
+        write_wav(os.path.join(out, name + ".wav"), chosen, result)
+        size, bus, adpcm_snr = len(result), chosen, "-"
+
+        if adpcm:
+            data, decoded = encode_adpcm(result)
+            with open(os.path.join(out, name + ".adpcm"), "wb") as file:
+                file.write(data)
+            size, bus, adpcm_snr = len(data), chosen // 2, "%.1f" % snr(result, decoded)
+
+        before = rom_size(len(samples) * driver_rate // rate)
+        after = rom_size(size)
+        totals[0] += before
+        totals[1] += after
+        print("%-12s %6d %6d %6d %6.1f %6s %8d %8d %5.0f%% %8d %8d" % (
+            name, len(samples) * 1000 // rate, len(trimmed) * 1000 // rate, chosen, min(chosen_snr, 99.9), adpcm_snr,
+            before, after, 100.0 * (before - after) / before, driver_rate // FRAME_RATE, bus // FRAME_RATE))
+
+    print("%-12s %6s %6s %6s %6s %6s %8d %8d %5.0f%%" % ("total", "", "", "", "", "", totals[0], totals[1],
+                                                          100.0 * (totals[0] - totals[1]) / totals[0]))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+#
+# Builds one VRAM tile set for several background images. Tiles are merged across
+# all images, tiles that only differ by a horizontal or vertical flip or by the
+# palette line become one tile, and the tilemaps are rewritten with the flip and
+# palette bits. Prints VRAM tiles before and after.
+# Animated regions get tiles of their own at the start of the set, in row order, so
+# the tile animation can swap their pixels without touching any other place. Later
+# regions of the same animation must match the first one and share its tiles.
+#
+# Takes indexed PNGs like rescomp IMAGE: low nibble color, bits 4-5 palette line,
+# bit 7 priority. Writes:
+#   <prefix>_tiles.png      tile set, one tile column, for a rescomp TILESET with NONE opt,
+#                           its palette holds the colors of all images
+#   <prefix>_<image>.bin    tilemap of each image, big-endian entries, index from 0
+#   <prefix>.h              tile count, tilemap sizes and animated tiles
+#
+# Usage: tile_optimizer.py out_prefix image.png [image.png ...] [--no-flip] [--no-palette]
+#                          [--animate name=image.png:x,y,w,h ...]
+#
+# Animated regions are in tiles, e.g. --animate star=res/back.png:11,8,4,4
+#
+
+import os
+import struct
+import sys
+import zlib
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """Return width, height, palette chunk and rows of pixel indices of an indexed PNG."""
+    with open(path, "rb") as file:
+        data = file.read()
+    if data[:8] != PNG_SIGNATURE:
+        sys.exit("%s: not a PNG" % path)
+
+    chunks = {}
+    idat = b""
+    pos = 8
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if kind == b"IDAT":
+            idat += body
+        else:
+            chunks.setdefault(kind, body)
+        pos += 12 + length
+
+    width, height, depth, color_type, _, _, interlace = struct.unpack(">2I5B", chunks[b"IHDR"])
+    if color_type != 3 or depth not in (4, 8) or interlace:
+        sys.exit("%s: needs a non-interlaced 4 or 8 bit indexed PNG" % path)
+
+    raw = zlib.decompress(idat)
+    stride = (width * depth + 7) // 8
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        kind = raw[start]
+        line = bytearray(raw[start + 1:start + 1 + stride])
+        for x in range(stride):
+            left = line[x - 1] if x else 0
+            up = previous[x]
+            corner = previous[x - 1] if x else 0
+            if kind == 1:
+                line[x] = (line[x] + left) & 0xFF
+            elif kind == 2:
+                line[x] = (line[x] + up) & 0xFF
+            elif kind == 3:
+                line[x] = (line[x] + (left + up) // 2) & 0xFF
+            elif kind == 4:
+                line[x] = (line[x] + paeth(left, up, corner)) & 0xFF
+        previous = line
+        if depth == 8:
+            rows.append(bytes(line))
+        else:
+            rows.append(bytes(line[x // 2] >> (4 - (x & 1) * 4) & 0xF for x in range(width)))
+
+    return width, height, chunks.get(b"PLTE", b""), rows
+
+
+def write_png(path, width, height, palette, rows):
+    """Write an 8 bit indexed PNG."""
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body) & 0xFFFFFFFF)
+
+    raw = b"".join(b"\0" + row for row in rows)
+    with open(path, "wb") as file:
+        file.write(PNG_SIGNATURE)
+        file.write(chunk(b"IHDR", struct.pack(">2I5B", width, height, 8, 3, 0, 0, 0)))
+        file.write(chunk(b"PLTE", palette))
+        file.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        file.write(chunk(b"IEND", b""))
+
+
+def cut_tiles(path, rows, width, height):
+    """Return the tiles of an image in map order as (pixels, palette, priority)."""
+    if width % 8 or height % 8:
+        sys.exit("%s: size is not a multiple of 8" % path)
+
+    tiles = []
+    for ty in range(height // 8):
+        for tx in range(width // 8):
+            block = b"".join(rows[ty * 8 + y][tx * 8:tx * 8 + 8] for y in range(8))
+            lines = {(pixel >> 4) & 3 for pixel in block if pixel & 0xF}
+            if len(lines) > 1:
+                sys.exit("%s: tile %d,%d uses more than one palette line" % (path, tx, ty))
+            tiles.append((bytes(pixel & 0xF for pixel in block), lines.pop() if lines else 0,
+                          any(pixel & 0x80 for pixel in block)))
+    return tiles
+
+
+def flip(pixels, h_flip, v_flip):
+    rows = [pixels[y * 8:y * 8 + 8] for y in range(8)]
+    if v_flip:
+        rows.reverse()
+    if h_flip:
+        rows = [row[::-1] for row in rows]
+    return b"".join(rows)
+
+
+class TilePool:
+    """Unique tiles and the map entry of every lookup."""
+
+    def __init__(self, flips, palettes):
+        self.flips = [(False, False), (True, False), (False, True), (True, True)] if flips else [(False, False)]
+        self.palettes = palettes
+        self.tiles = []
+        self.index = {}
+
+    def entry(self, pixels, palette, priority):
+        key_palette = 0 if self.palettes else palette
+        for h_flip, v_flip in self.flips:
+            found = self.index.get((flip(pixels, h_flip, v_flip), key_palette))
+            if found is not None:
+                break
+        else:
+            h_flip = v_flip = False
+            found = len(self.tiles)
+            self.tiles.append((pixels, key_palette))
+            self.index[(pixels, key_palette)] = found
+
+        # TILE_ATTR_FULL(palette, priority, flipV, flipH, index)
+        return (priority << 15) | (palette << 13) | (v_flip << 12) | (h_flip << 11) | found
+
+
+def parse_regions(args):
+    """Return the animated regions as (name, image path, x, y, w, h) from the --animate arguments."""
+    regions = []
+    for i, arg in enumerate(args):
+        if arg != "--animate":
+            continue
+        try:
+            name, spec = args[i + 1].split("=", 1)
+            path, box = spec.rsplit(":", 1)
+            regions.append((name, path) + tuple(int(value) for value in box.split(",")))
+        except (IndexError, ValueError):
+            sys.exit("--animate needs name=image.png:x,y,w,h")
+    return regions
+
+
+def reserve_regions(pool, regions, images):
+    """Give animated regions their own tiles, return the map entry of every animated position."""
+    entries = {}
+    animations = {}
+    for name, path, x, y, w, h in regions:
+        image = next((image for image in images if image[4] == path), None)
+        if not image:
+            sys.exit("--animate %s: %s is not an input image" % (name, path))
+        _, tiles, width, height, _ = image
+        if x + w > width or y + h > height:
+            sys.exit("--animate %s: region is outside of %s" % (name, path))
+
+        region = [tiles[(y + ty) * width + x + tx] for ty in range(h) for tx in range(w)]
+        if name not in animations:
+            animations[name] = (len(pool.tiles), region)
+            pool.tiles += [(pixels, palette) for pixels, palette, _ in region]
+        elif [tile[0] for tile in animations[name][1]] != [tile[0] for tile in region]:
+            sys.exit("--animate %s: region in %s differs from the first one" % (name, path))
+
+        first = animations[name][0]
+        for i, (_, palette, priority) in enumerate(region):
+            entries[(path, (y + i // w) * width + x + i % w)] = (priority << 15) | (palette << 13) | (first + i)
+
+    return entries, {name: (first, len(region)) for name, (first, region) in animations.items()}
+
+
+def count_tiles(images, merge, flips, palettes):
+    """VRAM tiles of the images with the given optimizations."""
+    total = 0
+    pool = TilePool(flips, palettes)
+    for _, tiles, _, _, _ in images:
+        if not merge:
+            pool = TilePool(flips, palettes)
+        before = len(pool.tiles)
+        for tile in tiles:
+            pool.entry(*tile)
+        total += len(pool.tiles) - before
+    return total
+
+
+def main():
+    regions = parse_regions(sys.argv)
+    args = [arg for i, arg in enumerate(sys.argv[1:]) if not arg.startswith("--") and sys.argv[i] != "--animate"]
+    flips = "--no-flip" not in sys.argv
+    palettes = "--no-palette" not in sys.argv
+    if len(args) < 2:
+        sys.exit("usage: tile_optimizer.py out_prefix image.png [image.png ...] [--no-flip] [--no-palette] "
+                 "[--animate name=image.png:x,y,w,h ...]")
+
+    prefix, paths = args[0], args[1:]
+    images = []
+    palette = bytearray(64 * 3)
+    owners = {}
+    for path in paths:
+        width, height, plte, rows = read_png(path)
+
+        # One palette for all images, each color taken from the image using it
+        for color in sorted({pixel & 0x3F for row in rows for pixel in row}):
+            rgb = plte[color * 3:color * 3 + 3]
+            if color in owners and palette[color * 3:color * 3 + 3] != rgb:
+                print("warning: color %d differs in %s and %s, %s wins" % (color, owners[color], path, owners[color]))
+                continue
+            owners.setdefault(color, path)
+            palette[color * 3:color * 3 + 3] = rgb
+
+        name = os.path.splitext(os.path.basename(path))[0]
+        images.append((name, cut_tiles(path, rows, width, height), width // 8, height // 8, path))
+
+    print("%-36s %6s" % ("VRAM tiles", "tiles"))
+    print("%-36s %6d" % ("tile grid", sum(len(image[1]) for image in images)))
+    print("%-36s %6d" % ("per image, exact (rescomp NONE opt)", count_tiles(images, False, False, False)))
+    print("%-36s %6d" % ("per image, flips (rescomp ALL opt)", count_tiles(images, False, True, False)))
+    print("%-36s %6d" % ("merged, exact", count_tiles(images, True, False, False)))
+    print("%-36s %6d" % ("merged, flips", count_tiles(images, True, True, False)))
+    print("%-36s %6d" % ("merged, flips and palette lines", count_tiles(images, True, True, True)))
+
+    pool = TilePool(flips, palettes)
+    animated, animations = reserve_regions(pool, regions, images)
+    guard = os.path.basename(prefix).upper()
+    header = ["// Generated with: tools/tile_optimizer.py %s" % " ".join(sys.argv[1:]), "// Do not edit", "",
+              "#ifndef HEADER_%s" % guard, "#define HEADER_%s" % guard, ""]
+
+    for name, tiles, width, height, path in images:
+        entries = [animated[(path, i)] if (path, i) in animated else pool.entry(*tile) for i, tile in enumerate(tiles)]
+        with open("%s_%s.bin" % (prefix, name), "wb") as file:
+            file.write(struct.pack(">%dH" % len(entries), *entries))
+        header.append("#define %s_%s_WIDTH %d" % (guard, name.upper(), width))
+        header.append("#define %s_%s_HEIGHT %d" % (guard, name.upper(), height))
+
+    for name, (first, count) in animations.items():
+        header.append("#define %s_%s_TILE %d" % (guard, name.upper(), first))
+        header.append("#define %s_%s_TILES %d" % (guard, name.upper(), count))
+
+    header += ["#define %s_TILES %d" % (guard, len(pool.tiles)), "", "#endif //HEADER_%s" % guard, ""]
+    with open(prefix + ".h", "w") as file:
+        file.write("\n".join(header))
+
+    rows = []
+    for pixels, _ in pool.tiles:
+        rows += [pixels[y * 8:y * 8 + 8] for y in range(8)]
+    write_png(prefix + "_tiles.png", 8, len(rows), bytes(palette), rows)
+
+    print("\nwrote %d tiles (%d bytes, %d animated) to %s_tiles.png" % (len(pool.tiles), len(pool.tiles) * 32,
+                                                                      sum(count for _, count in animations.values()),
+                                                                      prefix))
+
+
+if __name__ == "__main__":
+    main()
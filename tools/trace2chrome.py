@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+#
+# Converts a trace dump from the emulator debug log (Trace_Dump, KDebug port)
+# into Chrome trace JSON. Open the result in chrome://tracing or ui.perfetto.dev.
+#
+# Usage: trace2chrome.py emulator.log [trace.json]
+#
+
+import json
+import sys
+
+# Timeline row of each event
+EVENT_ROWS = {
+    "spawn_enemy": "objects",
+    "spawn_projectile": "objects",
+    "spawn_explosion": "objects",
+    "release": "objects",
+    "hit": "collision",
+    "pcm": "audio",
+    "dma_flush": "vblank",
+    "wave_switch": "waves",
+    "frame_drop": "frames",
+}
+
+# Argument names of each event, same order as in trace.h
+EVENT_ARGS = {
+    "spawn_enemy": ("x", "y"),
+    "spawn_projectile": ("x", "y"),
+    "spawn_explosion": ("x", "y"),
+    "release": ("x", "y"),
+    "hit": ("hp1", "hp2"),
+    "pcm": ("channel", "size"),
+    "dma_flush": ("transfers", "bytes"),
+    "wave_switch": ("pattern", "enemies"),
+    "frame_drop": ("missed", "steps"),
+}
+
+
+def parse_dump(lines):
+    """Return header values, event names and records of the last dump in the log."""
+    header = None
+    names = {}
+    records = []
+
+    for line in lines:
+        # Emulators prefix debug messages differently, look for the marker anywhere
+        pos = line.find("TRACE")
+        if pos < 0:
+            continue
+        fields = line[pos:].split()
+
+        if fields[0] == "TRACE_BEGIN":
+            header = dict(field.split("=") for field in fields[1:])
+            header = {key: int(value) for key, value in header.items()}
+            names = {}
+            records = []
+        elif fields[0] == "TRACE_EVENT" and header is not None:
+            names[int(fields[1])] = fields[2]
+        elif fields[0] == "TRACE" and header is not None:
+            records.append(tuple(int(value) for value in fields[1:6]))
+
+    if header is None:
+        sys.exit("no TRACE_BEGIN found in the log")
+
+    return header, names, records
+
+
+def to_chrome(header, names, records):
+    fps = header["fps"]
+    lines_per_frame = header["lines"]
+    line_us = 1000000.0 / (fps * lines_per_frame)
+
+    rows = sorted(set(EVENT_ROWS.values()))
+    events = [{"ph": "M", "name": "thread_name", "pid": 1, "tid": tid, "args": {"name": row}}
+              for tid, row in enumerate(rows)]
+    events.append({"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "scroll-shooter"}})
+
+    # The frame counter is 16 bits, unwrap it so time keeps growing
+    base = 0
+    last_frame = None
+    frames = set()
+
+    for frame, line, event, arg0, arg1 in records:
+        if last_frame is not None and frame < last_frame and last_frame - frame > 0x8000:
+            base += 0x10000
+        last_frame = frame
+        frame += base
+
+        # Lines count from the V-Int that started the vblank count, the game maps the V counter
+        ts = (frame * lines_per_frame + line) * line_us
+
+        name = names.get(event, "event_%d" % event)
+        row = EVENT_ROWS.get(name, "other")
+        if row not in rows:
+            rows.append(row)
+            events.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": rows.index(row), "args": {"name": row}})
+        arg_names = EVENT_ARGS.get(name, ("arg0", "arg1"))
+
+        events.append({"ph": "i", "s": "t", "name": name, "pid": 1, "tid": rows.index(row), "ts": ts,
+                       "args": {arg_names[0]: arg0, arg_names[1]: arg1, "line": line}})
+
+        if name == "dma_flush":
+            events.append({"ph": "C", "name": "dma bytes", "pid": 1, "ts": ts, "args": {"bytes": arg1}})
+
+        frames.add(frame)
+
+    # One span per frame so the event density per frame is easy to read
+    frame_us = lines_per_frame * line_us
+    frame_tid = len(rows)
+    events.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": frame_tid, "args": {"name": "vblank count"}})
+    for frame in sorted(frames):
+        events.append({"ph": "X", "name": "frame %d" % frame, "pid": 1, "tid": frame_tid,
+                       "ts": frame * frame_us, "dur": frame_us})
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: trace2chrome.py emulator.log [trace.json]")
+
+    with open(sys.argv[1], errors="replace") as log:
+        header, names, records = parse_dump(log)
+
+    output = sys.argv[2] if len(sys.argv) > 2 else "trace.json"
+    with open(output, "w") as file:
+        json.dump(to_chrome(header, names, records), file)
+
+    print("%d records written to %s" % (len(records), output))
+
+
+if __name__ == "__main__":
+    main()